@@ -0,0 +1,137 @@
+#include "EventLoop.hpp"
+
+#include <cerrno>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static const int MAX_EVENTS = 32;
+
+EventLoop::EventLoop() : epollfd(epoll_create1(EPOLL_CLOEXEC)), running(false)
+{
+    if(epollfd < 0){
+        std::cerr << "EventLoop: epoll_create1 failed" << std::endl;
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    for(auto& entry : watches){
+        if(entry.second->isTimer){
+            close(entry.first);
+        }
+    }
+    if(epollfd >= 0){
+        close(epollfd);
+    }
+}
+
+bool EventLoop::addWatch(int fd, std::shared_ptr<Watch> watch)
+{
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if(epoll_ctl(epollfd, EPOLL_CTL_ADD, fd, &ev) < 0){
+        std::cerr << "EventLoop: could not watch fd " << fd << std::endl;
+        return false;
+    }
+    watches[fd] = watch;
+    return true;
+}
+
+bool EventLoop::addReader(int fd, Callback cb)
+{
+    std::shared_ptr<Watch> watch(new Watch{std::move(cb), false, true});
+    return addWatch(fd, watch);
+}
+
+void EventLoop::removeReader(int fd)
+{
+    auto it = watches.find(fd);
+    if(it == watches.end()){
+        return;
+    }
+    epoll_ctl(epollfd, EPOLL_CTL_DEL, fd, nullptr);
+    watches.erase(it);
+}
+
+int EventLoop::addTimer(uint32_t period_ms, Callback cb, bool repeat)
+{
+    int timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(timerfd < 0){
+        std::cerr << "EventLoop: timerfd_create failed" << std::endl;
+        return -1;
+    }
+
+    itimerspec spec = {};
+    spec.it_value.tv_sec = period_ms / 1000;
+    spec.it_value.tv_nsec = (period_ms % 1000) * 1000000L;
+    if(spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0){
+        spec.it_value.tv_nsec = 1; // a zero it_value would disarm the timer
+    }
+    if(repeat){
+        spec.it_interval = spec.it_value;
+    }
+    timerfd_settime(timerfd, 0, &spec, nullptr);
+
+    std::shared_ptr<Watch> watch(new Watch{std::move(cb), true, repeat});
+    if(!addWatch(timerfd, watch)){
+        close(timerfd);
+        return -1;
+    }
+    return timerfd;
+}
+
+void EventLoop::cancelTimer(int id)
+{
+    auto it = watches.find(id);
+    if(it == watches.end() || !it->second->isTimer){
+        return;
+    }
+    removeReader(id);
+    close(id);
+}
+
+int EventLoop::runOnce(int timeout_ms)
+{
+    epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epollfd, events, MAX_EVENTS, timeout_ms);
+    if(n < 0){
+        return errno == EINTR ? 0 : -1;
+    }
+
+    int dispatched = 0;
+    for(int i = 0; i < n; i++){
+        int fd = events[i].data.fd;
+        auto it = watches.find(fd);
+        if(it == watches.end()){
+            continue; // removed by an earlier callback in this batch
+        }
+        std::shared_ptr<Watch> watch = it->second;
+
+        if(watch->isTimer){
+            uint64_t expirations;
+            if(read(fd, &expirations, sizeof(expirations)) < 0){
+                continue;
+            }
+            if(!watch->repeat){
+                cancelTimer(fd);
+            }
+        }
+        watch->cb();
+        dispatched++;
+    }
+    return dispatched;
+}
+
+void EventLoop::run()
+{
+    running = true;
+    while(running){
+        if(runOnce(-1) < 0){
+            std::cerr << "EventLoop: epoll_wait failed" << std::endl;
+            break;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+
+// Single-threaded epoll reactor. File descriptors (sockets, stdin) and
+// periodic timers (backed by timerfd) are all serviced from one wait, so a
+// slow reply on one socket never stalls the others.
+class EventLoop{
+public:
+    using Callback = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    bool ok() const { return epollfd >= 0; }
+
+    // Calls cb every time fd becomes readable. Returns false on failure.
+    bool addReader(int fd, Callback cb);
+    void removeReader(int fd);
+
+    // Calls cb every period_ms (or once if repeat is false). Returns a timer
+    // id for cancelTimer(), or -1 on failure.
+    int addTimer(uint32_t period_ms, Callback cb, bool repeat = true);
+    void cancelTimer(int id);
+
+    // Waits at most timeout_ms (-1 blocks) and dispatches whatever is ready.
+    // Returns the number of callbacks run, or -1 on error.
+    int runOnce(int timeout_ms);
+    void run();
+    void stop() { running = false; }
+
+private:
+    struct Watch{
+        Callback cb;
+        bool isTimer;
+        bool repeat;
+    };
+
+    int epollfd;
+    bool running;
+    // shared_ptr so a callback may remove itself (or others) while running
+    std::map<int, std::shared_ptr<Watch>> watches;
+
+    bool addWatch(int fd, std::shared_ptr<Watch> watch);
+};
+
+#endif //EVENT_LOOP_H
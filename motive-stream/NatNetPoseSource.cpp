@@ -0,0 +1,93 @@
+#include "NatNetPoseSource.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+NatNetPoseSource::NatNetPoseSource(EventLoop& loop, sNatNetClientConnectParams& params,
+                                   PoseHandler handler)
+    : loop(loop), client(nullptr), handler(std::move(handler)), wakefd(-1)
+{
+    mailbox.reserve(MAX_RIGIDBODIES);
+    drained.reserve(MAX_RIGIDBODIES);
+
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(wakefd < 0 || !loop.addReader(wakefd, [this]() { drain(); })){
+        std::cerr << "NatNetPoseSource: could not create wakeup fd" << std::endl;
+        return;
+    }
+
+    NatNetClient* natnet = new NatNetClient();
+    natnet->SetFrameReceivedCallback(handleFrame, this);
+    if(natnet->Connect(params) != ErrorCode_OK){
+        std::cerr << "NatNetPoseSource: error connecting to "
+                  << params.serverAddress << std::endl;
+        delete natnet;
+        return;
+    }
+    client = natnet;
+}
+
+NatNetPoseSource::~NatNetPoseSource()
+{
+    if(client){
+        client->Disconnect();
+        delete client;
+    }
+    if(wakefd >= 0){
+        loop.removeReader(wakefd);
+        close(wakefd);
+    }
+}
+
+void NATNET_CALLCONV NatNetPoseSource::handleFrame(sFrameOfMocapData* data, void* userData)
+{
+    NatNetPoseSource* self = static_cast<NatNetPoseSource*>(userData);
+    std::chrono::steady_clock::time_point arrival = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> guard(self->lock);
+        // Only the newest pose of each body matters to a controller, so a
+        // frame that the loop has not drained yet is simply overwritten.
+        self->mailbox.clear();
+        for(int i = 0; i < data->nRigidBodies; i++){
+            const sRigidBodyData& body = data->RigidBodies[i];
+            if(!(body.params & 0x01)){
+                continue; // not tracked in this frame
+            }
+            PoseSample sample;
+            sample.rigidBodyId = body.ID;
+            sample.arrival = arrival;
+            sample.pose.point.x = body.x;
+            sample.pose.point.y = body.y;
+            sample.pose.point.z = body.z;
+            sample.pose.quaternion.x = body.qx;
+            sample.pose.quaternion.y = body.qy;
+            sample.pose.quaternion.z = body.qz;
+            sample.pose.quaternion.w = body.qw;
+            self->mailbox.push_back(sample);
+        }
+    }
+    uint64_t one = 1;
+    if(write(self->wakefd, &one, sizeof(one)) < 0){
+        // Counter already non-zero: the loop has a wakeup pending.
+    }
+}
+
+void NatNetPoseSource::drain()
+{
+    uint64_t count;
+    if(read(wakefd, &count, sizeof(count)) < 0){
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        drained.swap(mailbox);
+        mailbox.clear();
+    }
+    if(handler){
+        for(const PoseSample& sample : drained){
+            handler(sample);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef NATNET_POSE_SOURCE_H
+#define NATNET_POSE_SOURCE_H
+
+#include <mutex>
+#include <vector>
+
+#include "NatNetTypes.h"
+#include "NatNetClient.h"
+
+#include "EventLoop.hpp"
+#include "PoseSource.hpp"
+
+// Feeds rigid-body poses from a NatNet client into an EventLoop.
+//
+// NatNet delivers frames on its own thread, so the frame callback only copies
+// the tracked rigid bodies into a mailbox and pokes an eventfd; the loop
+// thread drains the mailbox and runs the handler. Poses are expected in a
+// Z-up frame (set "Up Axis" to Z in Motive's streaming settings).
+class NatNetPoseSource{
+public:
+    NatNetPoseSource(EventLoop& loop, sNatNetClientConnectParams& params,
+                     PoseHandler handler);
+    ~NatNetPoseSource();
+
+    NatNetPoseSource(const NatNetPoseSource&) = delete;
+    NatNetPoseSource& operator=(const NatNetPoseSource&) = delete;
+
+    bool ok() const { return client != nullptr; }
+
+private:
+    EventLoop& loop;
+    NatNetClient* client;
+    PoseHandler handler;
+    int wakefd;
+
+    std::mutex lock;
+    std::vector<PoseSample> mailbox; // filled on the NatNet thread
+    std::vector<PoseSample> drained; // handed to the handler on the loop thread
+
+    static void NATNET_CALLCONV handleFrame(sFrameOfMocapData* data, void* userData);
+    void drain();
+};
+
+#endif //NATNET_POSE_SOURCE_H
@@ -0,0 +1,60 @@
+#include "PoseSource.hpp"
+
+#include <iostream>
+
+#include "vrpn_Connection.h"
+
+VrpnPoseSource::VrpnPoseSource(EventLoop& loop, const std::string& trackerAddress,
+                               PoseHandler handler, uint32_t poll_ms)
+    : loop(loop), connection(nullptr), tracker(nullptr),
+      handler(std::move(handler)), pollTimer(-1)
+{
+    connection = vrpn_get_connection_by_name(trackerAddress.c_str());
+    if(connection == nullptr){
+        std::cerr << "VrpnPoseSource: failed to create VRPN connection to "
+                  << trackerAddress << std::endl;
+        return;
+    }
+    tracker = new vrpn_Tracker_Remote(trackerAddress.c_str(), connection);
+    tracker->register_change_handler(this, handleTracker);
+
+    pollTimer = this->loop.addTimer(poll_ms, [this]() {
+        connection->mainloop();
+        tracker->mainloop();
+    });
+}
+
+VrpnPoseSource::~VrpnPoseSource()
+{
+    if(pollTimer >= 0){
+        loop.cancelTimer(pollTimer);
+    }
+    delete tracker;
+    if(connection){
+        connection->removeReference();
+    }
+}
+
+bool VrpnPoseSource::connected() const
+{
+    return connection != nullptr && connection->connected();
+}
+
+void VRPN_CALLBACK VrpnPoseSource::handleTracker(void* userData, const vrpn_TRACKERCB t)
+{
+    VrpnPoseSource* self = static_cast<VrpnPoseSource*>(userData);
+    PoseSample sample;
+    sample.arrival = std::chrono::steady_clock::now();
+    sample.rigidBodyId = t.sensor;
+    sample.pose.point.x = t.pos[0];
+    sample.pose.point.y = t.pos[1];
+    sample.pose.point.z = t.pos[2];
+    // VRPN quaternions are ordered x, y, z, w
+    sample.pose.quaternion.x = t.quat[0];
+    sample.pose.quaternion.y = t.quat[1];
+    sample.pose.quaternion.z = t.quat[2];
+    sample.pose.quaternion.w = t.quat[3];
+    if(self->handler){
+        self->handler(sample);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef POSE_SOURCE_H
+#define POSE_SOURCE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "EventLoop.hpp"
+#include "Messages.hpp"
+#include "vrpn_Tracker.h"
+
+// One rigid-body pose as it came off the mocap receiver. arrival is stamped
+// as soon as the receiver hands us the pose so that downstream latency
+// (pose -> command on the wire) can be measured.
+struct PoseSample{
+    int32_t rigidBodyId;
+    Pose_msg pose;
+    std::chrono::steady_clock::time_point arrival;
+};
+
+using PoseHandler = std::function<void(const PoseSample&)>;
+
+// Feeds poses from a VRPN tracker ("Tracker0@192.168.1.42") into an
+// EventLoop. VRPN does not expose its sockets, so the connection is pumped
+// from a short timer; callbacks then run on the loop thread and can be
+// handed straight to a controller.
+class VrpnPoseSource{
+public:
+    VrpnPoseSource(EventLoop& loop, const std::string& trackerAddress,
+                   PoseHandler handler, uint32_t poll_ms = 1);
+    ~VrpnPoseSource();
+
+    VrpnPoseSource(const VrpnPoseSource&) = delete;
+    VrpnPoseSource& operator=(const VrpnPoseSource&) = delete;
+
+    bool connected() const;
+
+private:
+    EventLoop& loop;
+    vrpn_Connection* connection;
+    vrpn_Tracker_Remote* tracker;
+    PoseHandler handler;
+    int pollTimer;
+
+    static void VRPN_CALLBACK handleTracker(void* userData, const vrpn_TRACKERCB t);
+};
+
+#endif //POSE_SOURCE_H
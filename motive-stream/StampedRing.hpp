@@ -0,0 +1,92 @@
+#ifndef STAMPED_RING_H
+#define STAMPED_RING_H
+
+#include <chrono>
+#include <cstddef>
+
+// Fixed-capacity ring of receive-time-stamped samples, oldest overwritten
+// first. Producers fill a slot in place (claim() then commit()) and readers
+// get const pointers into the ring, so a sample is never copied after it is
+// parsed. Not thread-safe: producers and readers all run on the EventLoop
+// thread (NatNet frames are handed over by NatNetPoseSource first).
+template <typename T, size_t N>
+class StampedRing{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    StampedRing() : head(0), count(0) {}
+
+    // Slot the next sample should be written into. When the ring is full
+    // that slot holds the oldest sample, so claiming it drops that sample
+    // first; readers never see a half-written slot, and a failed parse can
+    // just skip commit() at the cost of the oldest sample.
+    T& claim()
+    {
+        if(count == N){
+            count--;
+        }
+        return slots[head].value;
+    }
+
+    void commit(Clock::time_point stamp)
+    {
+        slots[head].stamp = stamp;
+        head = (head + 1) % N;
+        if(count < N){
+            count++;
+        }
+    }
+
+    size_t size() const { return count; }
+    static size_t capacity() { return N; }
+
+    // Newest sample, or nullptr if the ring is empty.
+    const T* latest(Clock::time_point* stamp = nullptr) const
+    {
+        if(count == 0){
+            return nullptr;
+        }
+        const Slot& slot = slots[(head + N - 1) % N];
+        if(stamp){
+            *stamp = slot.stamp;
+        }
+        return &slot.value;
+    }
+
+    // Sample whose stamp is closest to t, or nullptr if none lies within
+    // maxSkew. Walks back from the newest sample, which is where callers
+    // aligning against live data almost always find their match.
+    const T* nearest(Clock::time_point t, Clock::duration maxSkew,
+                     Clock::time_point* stamp = nullptr) const
+    {
+        const Slot* best = nullptr;
+        Clock::duration bestSkew = maxSkew;
+        for(size_t i = 1; i <= count; i++){
+            const Slot& slot = slots[(head + N - i) % N];
+            Clock::duration skew = slot.stamp > t ? slot.stamp - t : t - slot.stamp;
+            if(skew <= bestSkew){
+                best = &slot;
+                bestSkew = skew;
+            }
+            else if(slot.stamp < t){
+                break; // stamps only get older from here
+            }
+        }
+        if(best && stamp){
+            *stamp = best->stamp;
+        }
+        return best ? &best->value : nullptr;
+    }
+
+private:
+    struct Slot{
+        T value;
+        Clock::time_point stamp;
+    };
+
+    Slot slots[N];
+    size_t head;
+    size_t count;
+};
+
+#endif //STAMPED_RING_H
@@ -0,0 +1,100 @@
+#include "TelloCommandQueue.hpp"
+
+TelloCommandQueue::TelloCommandQueue(Transmit transmit)
+    : transmit(std::move(transmit)), counters()
+{
+}
+
+bool TelloCommandQueue::isIdempotent(const std::string& cmd)
+{
+    return cmd == "command" || (!cmd.empty() && cmd.back() == '?');
+}
+
+bool TelloCommandQueue::isMotion(const std::string& cmd)
+{
+    static const char* const verbs[] = {
+        "takeoff", "land", "up", "down", "left", "right", "forward", "back",
+        "cw", "ccw", "flip", "go", "curve", "jump"
+    };
+    std::string verb = cmd.substr(0, cmd.find(' '));
+    for(const char* v : verbs){
+        if(verb == v){
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t TelloCommandQueue::push(const std::string& cmd, ReplyCallback cb,
+                                 uint32_t timeout_ms, int retries)
+{
+    PendingCommand pending;
+    pending.text = cmd;
+    pending.cb = std::move(cb);
+    pending.seq = ++counters.lastQueuedSeq;
+    pending.timeout_ms = timeout_ms ? timeout_ms
+                                    : (isMotion(cmd) ? MOTION_TIMEOUT_MS : DEFAULT_TIMEOUT_MS);
+    pending.retriesLeft = retries >= 0 ? retries : (isIdempotent(cmd) ? 2 : 0);
+    pending.onWire = false;
+    queue.push_back(std::move(pending));
+
+    if(queue.size() == 1){
+        transmitHead();
+    }
+    return counters.lastQueuedSeq;
+}
+
+void TelloCommandQueue::transmitHead()
+{
+    if(queue.empty()){
+        return;
+    }
+    PendingCommand& head = queue.front();
+    head.sentAt = Clock::now();
+    head.onWire = true;
+    transmit(head.text.data(), head.text.size());
+    counters.commandsSent++;
+}
+
+void TelloCommandQueue::finishHead(bool ok, const std::string& reply)
+{
+    ReplyCallback cb = std::move(queue.front().cb);
+    counters.lastCompletedSeq = queue.front().seq;
+    queue.pop_front();
+    // Put the next command on the wire before running the callback so a
+    // callback that queues more work keeps FIFO order.
+    transmitHead();
+    if(cb){
+        cb(ok, reply);
+    }
+}
+
+bool TelloCommandQueue::onReply(const std::string& reply)
+{
+    if(queue.empty() || !queue.front().onWire){
+        counters.unmatchedReplies++;
+        return false;
+    }
+    finishHead(reply.compare(0, 5, "error") != 0, reply);
+    return true;
+}
+
+void TelloCommandQueue::onTick(Clock::time_point now)
+{
+    if(queue.empty() || !queue.front().onWire){
+        return;
+    }
+    PendingCommand& head = queue.front();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - head.sentAt);
+    if(elapsed.count() < head.timeout_ms){
+        return;
+    }
+    if(head.retriesLeft > 0){
+        head.retriesLeft--;
+        counters.retries++;
+        transmitHead();
+        return;
+    }
+    counters.timeouts++;
+    finishHead(false, "timeout");
+}
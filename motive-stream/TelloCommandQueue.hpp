@@ -0,0 +1,79 @@
+#ifndef TELLO_COMMAND_QUEUE_H
+#define TELLO_COMMAND_QUEUE_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+// Outstanding acknowledged commands for one Tello.
+//
+// The Tello answers each control/read command with a bare "ok", "error" or
+// value and does not tag replies, so commands are kept in a FIFO and only
+// the head is on the wire; its reply (or final timeout) releases the next.
+// Every command gets a sequence number so callers can tell how far a drone
+// has progressed through what was queued for it.
+class TelloCommandQueue{
+public:
+    using Clock = std::chrono::steady_clock;
+    using ReplyCallback = std::function<void(bool ok, const std::string& reply)>;
+    using Transmit = std::function<bool(const char* data, size_t len)>;
+
+    static const uint32_t DEFAULT_TIMEOUT_MS = 1000;
+    // Movement commands only reply once the move is finished.
+    static const uint32_t MOTION_TIMEOUT_MS = 10000;
+
+    struct Stats{
+        uint64_t commandsSent;
+        uint64_t retries;
+        uint64_t timeouts;
+        uint64_t unmatchedReplies;
+        uint32_t lastQueuedSeq;
+        uint32_t lastCompletedSeq;
+    };
+
+    explicit TelloCommandQueue(Transmit transmit);
+
+    // Queues cmd and returns its sequence number. cb runs with the reply, or
+    // with ok == false and reply == "timeout" once all retries are used up.
+    // timeout_ms == 0 picks a default for the command; retries < 0 retries
+    // only commands that are safe to repeat ("command", queries ending in '?').
+    uint32_t push(const std::string& cmd, ReplyCallback cb = nullptr,
+                  uint32_t timeout_ms = 0, int retries = -1);
+
+    // Matches a reply to the head. Returns false if nothing was outstanding.
+    bool onReply(const std::string& reply);
+
+    // Retries or fails the head if its timeout has passed.
+    void onTick(Clock::time_point now);
+
+    // Drops every queued command without calling its callback.
+    void clear() { queue.clear(); }
+
+    size_t size() const { return queue.size(); }
+    const Stats& stats() const { return counters; }
+
+    static bool isIdempotent(const std::string& cmd);
+    static bool isMotion(const std::string& cmd);
+
+private:
+    struct PendingCommand{
+        std::string text;
+        ReplyCallback cb;
+        uint32_t seq;
+        uint32_t timeout_ms;
+        int retriesLeft;
+        Clock::time_point sentAt;
+        bool onWire;
+    };
+
+    Transmit transmit;
+    std::deque<PendingCommand> queue;
+    Stats counters;
+
+    void transmitHead();
+    void finishHead(bool ok, const std::string& reply);
+};
+
+#endif //TELLO_COMMAND_QUEUE_H
@@ -0,0 +1,229 @@
+#include "TelloController.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static double wrapAngle(double angle)
+{
+    while(angle > M_PI){
+        angle -= 2.0 * M_PI;
+    }
+    while(angle < -M_PI){
+        angle += 2.0 * M_PI;
+    }
+    return angle;
+}
+
+static int clampRc(double value, int limit)
+{
+    return static_cast<int>(std::lround(std::max(-double(limit), std::min(double(limit), value))));
+}
+
+double PidAxis::update(double setpoint, double measurement, double dt)
+{
+    double error = setpoint - measurement;
+    integral += error * dt;
+    if(integralLimit > 0.0){
+        integral = std::max(-integralLimit, std::min(integralLimit, integral));
+    }
+    double derivative = 0.0;
+    if(primed && dt > 0.0){
+        derivative = -(measurement - lastMeasurement) / dt;
+    }
+    lastMeasurement = measurement;
+    primed = true;
+    return kp * error + ki * integral + kd * derivative;
+}
+
+TelloController::Config::Config()
+    : rigidBodyId(-1), rate_hz(30.0), maxPoseAge_ms(100.0), maxRc(50), maxYawRc(60),
+      x(80.0, 5.0, 40.0, 20.0), y(80.0, 5.0, 40.0, 20.0), z(100.0, 10.0, 30.0, 20.0),
+      yaw(80.0, 0.0, 10.0, 0.0), attitudeSkew_ms(60.0), imuYawGain(0.05)
+{
+}
+
+TelloController::TelloController(EventLoop& loop, TelloEngine& tello, const Config& config)
+    : TelloController(loop, [&tello](int a, int b, int c, int d) { return tello.sendRc(a, b, c, d); },
+                      config)
+{
+}
+
+TelloController::TelloController(EventLoop& loop, RcSink sink, const Config& config)
+    : loop(loop), sendRc(std::move(sink)), config(config), watchdogTimer(-1), active(false),
+      targetPosition{0.0, 0.0, 1.0}, targetYaw(0.0), havePose(false), latestPose(),
+      attitude(nullptr), haveImuOffset(false), imuYawOffset(0.0),
+      haveYaw(false), unwrappedYaw(0.0), lastRawYaw(0.0), lastRc{0, 0, 0, 0}, stats()
+{
+    uint32_t period_ms = static_cast<uint32_t>(1000.0 / config.rate_hz);
+    watchdogTimer = loop.addTimer(period_ms, [this]() { onWatchdog(); });
+}
+
+TelloController::~TelloController()
+{
+    if(watchdogTimer >= 0){
+        loop.cancelTimer(watchdogTimer);
+    }
+}
+
+double TelloController::yawFromQuaternion(const Quaternion& q)
+{
+    return std::atan2(2.0 * (q.w * q.z + q.x * q.y), 1.0 - 2.0 * (q.y * q.y + q.z * q.z));
+}
+
+void TelloController::setTarget(const Point& position, double yaw)
+{
+    targetPosition = position;
+    targetYaw = wrapAngle(yaw);
+}
+
+void TelloController::enable()
+{
+    config.x.reset();
+    config.y.reset();
+    config.z.reset();
+    config.yaw.reset();
+    lastStep = Clock::time_point();
+    haveYaw = false;
+    std::fill(lastRc, lastRc + 4, 0);
+    active = true;
+}
+
+void TelloController::disable()
+{
+    if(active){
+        hover();
+    }
+    active = false;
+}
+
+void TelloController::onPose(const PoseSample& sample)
+{
+    if(config.rigidBodyId >= 0 && sample.rigidBodyId != config.rigidBodyId){
+        return;
+    }
+    latestPose = sample;
+    havePose = true;
+
+    if(!active){
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    // Gate on the last step, not the last send: the watchdog's repeats
+    // send too, and must not hold back the next pose's step.
+    std::chrono::duration<double> sinceStep = now - lastStep;
+    // Allow a little slack so timer jitter does not skip whole periods.
+    if(sinceStep.count() >= 0.9 / config.rate_hz){
+        step(now);
+    }
+}
+
+void TelloController::onWatchdog()
+{
+    if(!active){
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    std::chrono::duration<double, std::milli> age = now - latestPose.arrival;
+    if(!havePose || age.count() > config.maxPoseAge_ms){
+        hover();
+        stats.staleHovers++;
+        return;
+    }
+    // Only poses drive control steps. If none has for a period, repeat the
+    // last setpoint rather than re-running the loop on feedback it has
+    // already acted on.
+    std::chrono::duration<double> sinceSend = now - lastSend;
+    if(sinceSend.count() >= 0.9 / config.rate_hz){
+        send(lastRc[0], lastRc[1], lastRc[2], lastRc[3]);
+    }
+}
+
+void TelloController::step(Clock::time_point now)
+{
+    double dt = 1.0 / config.rate_hz;
+    if(lastStep != Clock::time_point()){
+        dt = std::chrono::duration<double>(now - lastStep).count();
+        // After a stale-pose gap, don't let one step integrate the whole gap.
+        dt = std::min(dt, 2.0 / config.rate_hz);
+    }
+    lastStep = now;
+
+    const Point& p = latestPose.pose.point;
+    double yaw = yawFromQuaternion(latestPose.pose.quaternion);
+
+    // World-frame corrections, rotated into the body frame below.
+    double ux = config.x.update(targetPosition.x, p.x, dt);
+    double uy = config.y.update(targetPosition.y, p.y, dt);
+    double uz = config.z.update(targetPosition.z, p.z, dt);
+    // Track heading continuously so neither the error nor the derivative
+    // jumps by 2*pi when crossing +-180 degrees.
+    unwrappedYaw = haveYaw ? unwrappedYaw + wrapAngle(yaw - lastRawYaw) : yaw;
+    lastRawYaw = yaw;
+    haveYaw = true;
+    double uyaw = config.yaw.update(unwrappedYaw + wrapAngle(targetYaw - yaw), unwrappedYaw, dt);
+
+    double heading = fusedHeading(yaw);
+    double forward = std::cos(heading) * ux + std::sin(heading) * uy;
+    double left = -std::sin(heading) * ux + std::cos(heading) * uy;
+
+    // rc a: right positive, b: forward, c: up, d: clockwise (i.e. -yaw)
+    send(clampRc(-left, config.maxRc), clampRc(forward, config.maxRc),
+         clampRc(uz, config.maxRc), clampRc(-uyaw, config.maxYawRc));
+    recordLatency(std::chrono::duration<double, std::milli>(lastSend - latestPose.arrival).count());
+}
+
+double TelloController::fusedHeading(double mocapYaw)
+{
+    if(attitude == nullptr){
+        return mocapYaw;
+    }
+    auto skew = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(config.attitudeSkew_ms));
+    const TelloState* state = attitude->nearest(latestPose.arrival, skew);
+    if(state == nullptr){
+        return mocapYaw;
+    }
+    // Tello yaw is clockwise-positive degrees with an arbitrary zero.
+    double imuYaw = -state->yaw * M_PI / 180.0;
+    double offset = wrapAngle(mocapYaw - imuYaw);
+    if(!haveImuOffset){
+        imuYawOffset = offset;
+        haveImuOffset = true;
+    }
+    else{
+        imuYawOffset = wrapAngle(imuYawOffset + config.imuYawGain * wrapAngle(offset - imuYawOffset));
+    }
+    stats.fusedSteps++;
+    return wrapAngle(imuYaw + imuYawOffset);
+}
+
+void TelloController::hover()
+{
+    send(0, 0, 0, 0);
+}
+
+void TelloController::send(int a, int b, int c, int d)
+{
+    sendRc(a, b, c, d);
+    lastRc[0] = a;
+    lastRc[1] = b;
+    lastRc[2] = c;
+    lastRc[3] = d;
+    lastSend = Clock::now();
+}
+
+void TelloController::recordLatency(double ms)
+{
+    if(stats.samples == 0){
+        stats.min_ms = ms;
+        stats.max_ms = ms;
+    }
+    stats.min_ms = std::min(stats.min_ms, ms);
+    stats.max_ms = std::max(stats.max_ms, ms);
+    stats.samples++;
+    stats.mean_ms += (ms - stats.mean_ms) / stats.samples;
+    if(ms > config.maxPoseAge_ms){
+        stats.overBudget++;
+    }
+}
@@ -0,0 +1,133 @@
+#ifndef TELLO_CONTROLLER_H
+#define TELLO_CONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "EventLoop.hpp"
+#include "Messages.hpp"
+#include "PoseSource.hpp"
+#include "TelloEngine.hpp"
+#include "TelloState.hpp"
+
+// PID on one axis. Derivative acts on the measurement (not the error) so a
+// setpoint change does not kick the output.
+struct PidAxis{
+    double kp;
+    double ki;
+    double kd;
+    double integralLimit;
+
+    double integral;
+    double lastMeasurement;
+    bool primed;
+
+    PidAxis(double kp = 0.0, double ki = 0.0, double kd = 0.0, double integralLimit = 0.0)
+        : kp(kp), ki(ki), kd(kd), integralLimit(integralLimit),
+          integral(0.0), lastMeasurement(0.0), primed(false) {}
+
+    double update(double setpoint, double measurement, double dt);
+    void reset() { integral = 0.0; primed = false; }
+};
+
+// Closed-loop position controller: mocap pose in, "rc a b c d" out.
+//
+// A control step runs as soon as a pose arrives, so pose -> command latency
+// is just the processing time, but steps are rate limited to rate_hz so a
+// 240 Hz mocap stream does not flood the drone. A watchdog timer at the same
+// rate sends a hover setpoint (rc 0 0 0 0) whenever the newest pose is older
+// than maxPoseAge_ms -- the loop never acts on stale feedback -- and
+// otherwise repeats the last setpoint if no pose has driven a step.
+//
+// Frames: world is Z-up, yaw is about +Z (counter-clockwise positive).
+class TelloController{
+public:
+    using Clock = std::chrono::steady_clock;
+    // Where rc setpoints go: a TelloEngine, or one drone of a TelloSwarm.
+    using RcSink = std::function<bool(int roll, int pitch, int throttle, int yaw)>;
+
+    struct Config{
+        int32_t rigidBodyId;      // -1 accepts any body
+        double rate_hz;           // 20-50 Hz is what the Tello SDK handles well
+        double maxPoseAge_ms;
+        int maxRc;                // clamp for the horizontal/vertical channels
+        int maxYawRc;
+        PidAxis x, y, z, yaw;     // x/y/z in rc units per metre, yaw per radian
+        double attitudeSkew_ms;   // max pose/state receive-time gap to fuse
+        double imuYawGain;        // 0..1, how fast the IMU yaw offset tracks mocap
+
+        Config();
+    };
+
+    struct LatencyStats{
+        uint64_t samples;         // commands sent from a fresh pose
+        uint64_t overBudget;      // of those, how many exceeded maxPoseAge_ms
+        uint64_t staleHovers;     // hover setpoints sent by the watchdog
+        uint64_t fusedSteps;      // steps that used onboard attitude
+        double min_ms;
+        double max_ms;
+        double mean_ms;
+    };
+
+    TelloController(EventLoop& loop, TelloEngine& tello, const Config& config = Config());
+    TelloController(EventLoop& loop, RcSink sink, const Config& config = Config());
+    ~TelloController();
+
+    TelloController(const TelloController&) = delete;
+    TelloController& operator=(const TelloController&) = delete;
+
+    // Target position (metres) and heading (radians).
+    void setTarget(const Point& position, double yaw);
+
+    // Starts/stops streaming rc commands. Stopping sends one hover setpoint.
+    void enable();
+    void disable();
+    bool enabled() const { return active; }
+
+    // Hand every pose from a PoseSource here.
+    void onPose(const PoseSample& sample);
+
+    // Onboard attitude from TelloTelemetry. When a state is received close
+    // enough to the pose, the heading used to rotate corrections into the
+    // body frame comes from the IMU yaw, offset-corrected against mocap --
+    // smoother than a yaw derived from a small marker cluster. Heading
+    // control itself still closes on mocap. nullptr turns this off.
+    void setAttitudeSource(const TelloStateRing* ring) { attitude = ring; }
+
+    const LatencyStats& latency() const { return stats; }
+
+    static double yawFromQuaternion(const Quaternion& q);
+
+private:
+    EventLoop& loop;
+    RcSink sendRc;
+    Config config;
+    int watchdogTimer;
+    bool active;
+
+    Point targetPosition;
+    double targetYaw;
+
+    bool havePose;
+    PoseSample latestPose;
+    const TelloStateRing* attitude;
+    bool haveImuOffset;
+    double imuYawOffset;
+    bool haveYaw;
+    double unwrappedYaw;
+    double lastRawYaw;
+    Clock::time_point lastStep;
+    Clock::time_point lastSend;
+    int lastRc[4];
+    LatencyStats stats;
+
+    void step(Clock::time_point now);
+    double fusedHeading(double mocapYaw);
+    void hover();
+    void send(int a, int b, int c, int d);
+    void onWatchdog();
+    void recordLatency(double ms);
+};
+
+#endif //TELLO_CONTROLLER_H
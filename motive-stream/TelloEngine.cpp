@@ -0,0 +1,140 @@
+#include "TelloEngine.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Granularity of the command timeout check.
+static const uint32_t TICK_MS = 20;
+
+TelloEngine::TelloEngine(EventLoop& loop, const std::string& telloIp,
+                         uint16_t telloPort, uint16_t localPort)
+    : loop(loop), socketfd(-1), tickTimer(-1),
+      commands([this](const char* data, size_t len) { return transmit(data, len); }),
+      rcSent(0)
+{
+    memset(&telloAddress, 0, sizeof(telloAddress));
+    telloAddress.sin_family = AF_INET;
+    telloAddress.sin_port = htons(telloPort);
+    if(inet_pton(AF_INET, telloIp.c_str(), &telloAddress.sin_addr) != 1){
+        std::cerr << "TelloEngine: bad Tello address " << telloIp << std::endl;
+        return;
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        std::cerr << "TelloEngine: could not create socket" << std::endl;
+        return;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in localAddress;
+    memset(&localAddress, 0, sizeof(localAddress));
+    localAddress.sin_family = AF_INET;
+    localAddress.sin_port = htons(localPort);
+    localAddress.sin_addr.s_addr = INADDR_ANY;
+    if(bind(fd, (struct sockaddr*)&localAddress, sizeof(localAddress)) < 0){
+        std::cerr << "TelloEngine: could not bind port " << localPort << std::endl;
+        close(fd);
+        return;
+    }
+
+    if(!loop.addReader(fd, [this]() { onReadable(); })){
+        close(fd);
+        return;
+    }
+    socketfd = fd;
+    tickTimer = loop.addTimer(TICK_MS, [this]() {
+        commands.onTick(TelloCommandQueue::Clock::now());
+    });
+}
+
+TelloEngine::~TelloEngine()
+{
+    if(tickTimer >= 0){
+        loop.cancelTimer(tickTimer);
+    }
+    if(socketfd >= 0){
+        loop.removeReader(socketfd);
+        close(socketfd);
+    }
+}
+
+void TelloEngine::sendCommand(const std::string& cmd, ReplyCallback cb,
+                              uint32_t timeout_ms, int retries)
+{
+    commands.push(cmd, std::move(cb), timeout_ms, retries);
+}
+
+bool TelloEngine::sendRc(int roll, int pitch, int throttle, int yaw)
+{
+    char buf[64];
+    int len = snprintf(buf, sizeof(buf), "rc %d %d %d %d", roll, pitch, throttle, yaw);
+    if(!transmit(buf, len)){
+        return false;
+    }
+    rcSent++;
+    return true;
+}
+
+TelloEngine::Stats TelloEngine::stats() const
+{
+    const TelloCommandQueue::Stats& queued = commands.stats();
+    Stats stats;
+    stats.commandsSent = queued.commandsSent;
+    stats.retries = queued.retries;
+    stats.timeouts = queued.timeouts;
+    stats.unmatchedReplies = queued.unmatchedReplies;
+    stats.rcSent = rcSent;
+    return stats;
+}
+
+bool TelloEngine::transmit(const char* data, size_t len)
+{
+    if(socketfd < 0){
+        return false;
+    }
+    ssize_t bytes_sent = sendto(socketfd, data, len, 0,
+                                (struct sockaddr*)&telloAddress, sizeof(telloAddress));
+    if(bytes_sent < 0){
+        // EAGAIN means the socket buffer is full; rc setpoints are superseded
+        // by the next tick anyway, and commands get retried on timeout.
+        if(errno != EAGAIN && errno != EWOULDBLOCK){
+            std::cerr << "TelloEngine: sendto failed: " << strerror(errno) << std::endl;
+        }
+        return false;
+    }
+    return true;
+}
+
+void TelloEngine::onReadable()
+{
+    char buf[1024];
+    while(true){
+        sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        ssize_t bytes_recv = recvfrom(socketfd, buf, sizeof(buf) - 1, 0,
+                                      (struct sockaddr*)&from, &fromlen);
+        if(bytes_recv < 0){
+            return; // drained (EAGAIN) or transient error
+        }
+        if(from.sin_addr.s_addr != telloAddress.sin_addr.s_addr){
+            continue;
+        }
+        // Replies sometimes carry a trailing "\r\n"
+        while(bytes_recv > 0 && (buf[bytes_recv - 1] == '\n' || buf[bytes_recv - 1] == '\r')){
+            bytes_recv--;
+        }
+        std::string reply(buf, bytes_recv);
+
+        if(!commands.onReply(reply) && unsolicited){
+            unsolicited(reply);
+        }
+    }
+}
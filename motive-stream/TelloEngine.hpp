@@ -0,0 +1,80 @@
+#ifndef TELLO_ENGINE_H
+#define TELLO_ENGINE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <netinet/in.h>
+
+#include "EventLoop.hpp"
+#include "TelloCommandQueue.hpp"
+
+// Non-blocking Tello SDK command engine driven by an EventLoop.
+//
+// Acknowledged commands go through a TelloCommandQueue (one on the wire at a
+// time, replies matched in order). "rc" velocity setpoints are never
+// acknowledged by the drone, so they bypass the queue entirely and go out
+// immediately -- a slow "takeoff" reply never delays the control loop.
+class TelloEngine{
+public:
+    using ReplyCallback = TelloCommandQueue::ReplyCallback;
+
+    static const uint32_t DEFAULT_TIMEOUT_MS = TelloCommandQueue::DEFAULT_TIMEOUT_MS;
+    static const uint32_t MOTION_TIMEOUT_MS = TelloCommandQueue::MOTION_TIMEOUT_MS;
+
+    struct Stats{
+        uint64_t commandsSent;
+        uint64_t retries;
+        uint64_t timeouts;
+        uint64_t rcSent;
+        uint64_t unmatchedReplies;
+    };
+
+    TelloEngine(EventLoop& loop, const std::string& telloIp = "192.168.10.1",
+                uint16_t telloPort = 8889, uint16_t localPort = 8889);
+    ~TelloEngine();
+
+    TelloEngine(const TelloEngine&) = delete;
+    TelloEngine& operator=(const TelloEngine&) = delete;
+
+    bool ok() const { return socketfd >= 0; }
+
+    // See TelloCommandQueue::push() for the timeout/retry defaults.
+    void sendCommand(const std::string& cmd, ReplyCallback cb = nullptr,
+                     uint32_t timeout_ms = 0, int retries = -1);
+
+    // Sends "rc a b c d" (each -100..100) right away. Returns false if the
+    // datagram could not be handed to the kernel.
+    bool sendRc(int roll, int pitch, int throttle, int yaw);
+
+    // Drops every queued command without calling its callback.
+    void clearQueue() { commands.clear(); }
+
+    size_t pending() const { return commands.size(); }
+    Stats stats() const;
+
+    // Called for datagrams that arrive while no command is outstanding.
+    void setUnsolicitedHandler(std::function<void(const std::string&)> handler)
+    {
+        unsolicited = std::move(handler);
+    }
+
+    static bool isIdempotent(const std::string& cmd)
+    {
+        return TelloCommandQueue::isIdempotent(cmd);
+    }
+
+private:
+    EventLoop& loop;
+    int socketfd;
+    int tickTimer;
+    sockaddr_in telloAddress;
+    TelloCommandQueue commands;
+    std::function<void(const std::string&)> unsolicited;
+    uint64_t rcSent;
+
+    bool transmit(const char* data, size_t len);
+    void onReadable();
+};
+
+#endif //TELLO_ENGINE_H
@@ -0,0 +1,381 @@
+#include "TelloSim.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "vrpn_Connection.h"
+#include "vrpn_Tracker.h"
+
+static double wrapAngle(double angle)
+{
+    while(angle > M_PI){
+        angle -= 2.0 * M_PI;
+    }
+    while(angle < -M_PI){
+        angle += 2.0 * M_PI;
+    }
+    return angle;
+}
+
+static uint32_t periodMs(double hz)
+{
+    return std::max<uint32_t>(1, static_cast<uint32_t>(1000.0 / hz));
+}
+
+TelloSim::Config::Config()
+    : commandPort(8889), statePort(8890), physics_hz(200.0), mocap_hz(120.0), state_hz(10.0),
+      maxSpeed(1.0), maxYawRate(M_PI / 2.0), velocityTau(0.25), takeoffHeight(0.8),
+      idleLand_s(15.0)
+{
+}
+
+TelloSim::TelloSim(EventLoop& loop, vrpn_Connection* connection,
+                   const char* trackerName, const Config& config)
+    : loop(loop), config(config), connection(connection), tracker(nullptr), socketfd(-1),
+      timers{-1, -1, -1}, sdkMode(false), haveClient(false), mode(GROUNDED), current(),
+      yaw(0.0), velocity(), rcVelocity(), rcYawRate(0.0), moveTarget(), yawTarget(0.0),
+      moveSpeed(0.5), rcSinceLastPose(true), battery(100), counters()
+{
+    current.quaternion.w = 1.0;
+    memset(&client, 0, sizeof(client));
+
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        std::cerr << "TelloSim: could not create socket" << std::endl;
+        return;
+    }
+    sockaddr_in localAddress;
+    memset(&localAddress, 0, sizeof(localAddress));
+    localAddress.sin_family = AF_INET;
+    localAddress.sin_port = htons(config.commandPort);
+    localAddress.sin_addr.s_addr = INADDR_ANY;
+    if(bind(fd, (struct sockaddr*)&localAddress, sizeof(localAddress)) < 0){
+        std::cerr << "TelloSim: could not bind port " << config.commandPort << std::endl;
+        close(fd);
+        return;
+    }
+    if(!loop.addReader(fd, [this]() { onReadable(); })){
+        close(fd);
+        return;
+    }
+    socketfd = fd;
+
+    if(connection){
+        tracker = new vrpn_Tracker_Server(trackerName, connection, 1);
+    }
+
+    lastCommand = Clock::now();
+    double dt = 1.0 / config.physics_hz;
+    timers[0] = loop.addTimer(periodMs(config.physics_hz), [this, dt]() { step(dt); });
+    timers[1] = loop.addTimer(periodMs(config.mocap_hz), [this]() { publishPose(); });
+    timers[2] = loop.addTimer(periodMs(config.state_hz), [this]() { sendState(); });
+}
+
+TelloSim::~TelloSim()
+{
+    for(int timer : timers){
+        if(timer >= 0){
+            loop.cancelTimer(timer);
+        }
+    }
+    delete tracker;
+    if(socketfd >= 0){
+        loop.removeReader(socketfd);
+        close(socketfd);
+    }
+}
+
+void TelloSim::resetStats()
+{
+    counters = Stats();
+}
+
+void TelloSim::reply(const std::string& text)
+{
+    if(!haveClient){
+        return;
+    }
+    sendto(socketfd, text.data(), text.size(), 0, (struct sockaddr*)&client, sizeof(client));
+}
+
+void TelloSim::onReadable()
+{
+    char buf[256];
+    while(true){
+        sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        ssize_t bytes_recv = recvfrom(socketfd, buf, sizeof(buf), 0,
+                                      (struct sockaddr*)&from, &fromlen);
+        if(bytes_recv < 0){
+            return;
+        }
+        client = from;
+        haveClient = true;
+        lastCommand = Clock::now();
+        while(bytes_recv > 0 && (buf[bytes_recv - 1] == '\n' || buf[bytes_recv - 1] == '\r')){
+            bytes_recv--;
+        }
+        handleCommand(std::string(buf, bytes_recv));
+    }
+}
+
+void TelloSim::handleCommand(const std::string& cmd)
+{
+    if(cmd.compare(0, 3, "rc ") == 0){
+        counters.rcReceived++;
+        if(!rcSinceLastPose){
+            rcSinceLastPose = true;
+            recordLoop(std::chrono::duration<double, std::milli>(Clock::now() - lastPosePublish).count());
+        }
+        int a, b, c, d;
+        if(sdkMode && sscanf(cmd.c_str(), "rc %d %d %d %d", &a, &b, &c, &d) == 4){
+            // a: right, b: forward, c: up, d: clockwise; body frame is
+            // x forward, y left, z up.
+            rcVelocity.x = std::max(-100, std::min(100, b)) / 100.0 * config.maxSpeed;
+            rcVelocity.y = -std::max(-100, std::min(100, a)) / 100.0 * config.maxSpeed;
+            rcVelocity.z = std::max(-100, std::min(100, c)) / 100.0 * config.maxSpeed;
+            rcYawRate = -std::max(-100, std::min(100, d)) / 100.0 * config.maxYawRate;
+        }
+        return;
+    }
+    counters.commands++;
+
+    if(cmd == "command"){
+        sdkMode = true;
+        reply("ok");
+        return;
+    }
+    if(!sdkMode){
+        return; // a real Tello ignores everything until "command"
+    }
+
+    char verb[16] = {0};
+    int arg = 0;
+    int fields = sscanf(cmd.c_str(), "%15s %d", verb, &arg);
+    std::string v(verb);
+
+    if(v == "emergency"){
+        mode = GROUNDED;
+        current.point.z = 0.0;
+        velocity = Vector_3d();
+        reply("ok");
+    }
+    else if(v == "stop"){
+        if(mode == MOVING){
+            mode = HOVERING;
+            pendingReply.clear();
+        }
+        rcVelocity = Vector_3d();
+        rcYawRate = 0.0;
+        reply("ok");
+    }
+    else if(v == "battery?"){
+        reply(std::to_string(battery));
+    }
+    else if(v == "speed?"){
+        reply(std::to_string(static_cast<int>(moveSpeed * 100.0)));
+    }
+    else if(v == "height?"){
+        reply(std::to_string(static_cast<int>(current.point.z * 10.0)) + "dm");
+    }
+    else if(v == "time?"){
+        int seconds = mode == GROUNDED ? 0
+            : static_cast<int>(std::chrono::duration<double>(Clock::now() - flightStart).count());
+        reply(std::to_string(seconds) + "s");
+    }
+    else if(v == "speed" && fields == 2 && arg >= 10 && arg <= 100){
+        moveSpeed = arg / 100.0;
+        reply("ok");
+    }
+    else if(mode == TAKING_OFF || mode == LANDING || mode == MOVING){
+        reply("error"); // busy with a previous motion command
+    }
+    else if(v == "takeoff" && mode == GROUNDED){
+        mode = TAKING_OFF;
+        flightStart = Clock::now();
+        rcVelocity = Vector_3d();
+        rcYawRate = 0.0;
+        pendingReply = "ok";
+    }
+    else if(v == "land" && mode == HOVERING){
+        mode = LANDING;
+        pendingReply = "ok";
+    }
+    else if(mode == HOVERING && fields == 2 &&
+            (v == "up" || v == "down" || v == "left" || v == "right" ||
+             v == "forward" || v == "back") && arg >= 20 && arg <= 500){
+        double d = arg / 100.0;
+        double fx = 0.0, fy = 0.0, fz = 0.0;
+        if(v == "up") fz = d;
+        else if(v == "down") fz = -d;
+        else if(v == "forward") fx = d;
+        else if(v == "back") fx = -d;
+        else if(v == "left") fy = d;
+        else fy = -d;
+        moveTarget.x = current.point.x + std::cos(yaw) * fx - std::sin(yaw) * fy;
+        moveTarget.y = current.point.y + std::sin(yaw) * fx + std::cos(yaw) * fy;
+        moveTarget.z = std::max(0.2, current.point.z + fz);
+        yawTarget = yaw;
+        mode = MOVING;
+        pendingReply = "ok";
+    }
+    else if(mode == HOVERING && fields == 2 && (v == "cw" || v == "ccw") && arg >= 1 && arg <= 360){
+        moveTarget.x = current.point.x;
+        moveTarget.y = current.point.y;
+        moveTarget.z = current.point.z;
+        yawTarget = wrapAngle(yaw + (v == "cw" ? -1.0 : 1.0) * arg * M_PI / 180.0);
+        mode = MOVING;
+        pendingReply = "ok";
+    }
+    else{
+        reply("error");
+    }
+}
+
+void TelloSim::finishMove()
+{
+    if(!pendingReply.empty()){
+        reply(pendingReply);
+        pendingReply.clear();
+    }
+}
+
+void TelloSim::step(double dt)
+{
+    Vector_3d command = Vector_3d();
+    double yawRate = 0.0;
+
+    switch(mode){
+    case GROUNDED:
+        velocity = Vector_3d();
+        current.point.z = 0.0;
+        return;
+    case TAKING_OFF:
+        command.z = 0.7;
+        if(current.point.z >= config.takeoffHeight){
+            mode = HOVERING;
+            finishMove();
+        }
+        break;
+    case LANDING:
+        command.z = -0.5;
+        if(current.point.z <= 0.0){
+            mode = GROUNDED;
+            velocity = Vector_3d();
+            current.point.z = 0.0;
+            finishMove();
+            return;
+        }
+        break;
+    case HOVERING:
+        command.x = std::cos(yaw) * rcVelocity.x - std::sin(yaw) * rcVelocity.y;
+        command.y = std::sin(yaw) * rcVelocity.x + std::cos(yaw) * rcVelocity.y;
+        command.z = rcVelocity.z;
+        yawRate = rcYawRate;
+        if(std::chrono::duration<double>(Clock::now() - lastCommand).count() > config.idleLand_s){
+            mode = LANDING;
+        }
+        break;
+    case MOVING: {
+        double ex = moveTarget.x - current.point.x;
+        double ey = moveTarget.y - current.point.y;
+        double ez = moveTarget.z - current.point.z;
+        double dist = std::sqrt(ex * ex + ey * ey + ez * ez);
+        double eyaw = wrapAngle(yawTarget - yaw);
+        if(dist < 0.02 && std::fabs(eyaw) < M_PI / 180.0){
+            mode = HOVERING;
+            rcVelocity = Vector_3d();
+            rcYawRate = 0.0;
+            finishMove();
+            break;
+        }
+        double speed = std::min(moveSpeed, 2.0 * dist);
+        if(dist > 1e-6){
+            command.x = ex / dist * speed;
+            command.y = ey / dist * speed;
+            command.z = ez / dist * speed;
+        }
+        yawRate = std::max(-config.maxYawRate, std::min(config.maxYawRate, 3.0 * eyaw));
+        break;
+    }
+    }
+
+    double alpha = std::min(1.0, dt / config.velocityTau);
+    velocity.x += (command.x - velocity.x) * alpha;
+    velocity.y += (command.y - velocity.y) * alpha;
+    velocity.z += (command.z - velocity.z) * alpha;
+
+    current.point.x += velocity.x * dt;
+    current.point.y += velocity.y * dt;
+    current.point.z = std::max(0.0, current.point.z + velocity.z * dt);
+    yaw = wrapAngle(yaw + yawRate * dt);
+    current.quaternion.x = 0.0;
+    current.quaternion.y = 0.0;
+    current.quaternion.z = std::sin(yaw / 2.0);
+    current.quaternion.w = std::cos(yaw / 2.0);
+
+    double flight_s = std::chrono::duration<double>(Clock::now() - flightStart).count();
+    battery = std::max(0, 100 - static_cast<int>(flight_s / 6.0));
+}
+
+void TelloSim::publishPose()
+{
+    if(tracker == nullptr){
+        return;
+    }
+    timeval now;
+    vrpn_gettimeofday(&now, NULL);
+    vrpn_float64 pos[3] = {current.point.x, current.point.y, current.point.z};
+    vrpn_float64 quat[4] = {current.quaternion.x, current.quaternion.y,
+                            current.quaternion.z, current.quaternion.w};
+    tracker->report_pose(0, now, pos, quat);
+    tracker->mainloop();
+    connection->mainloop();
+    lastPosePublish = Clock::now();
+    rcSinceLastPose = false;
+    counters.posesPublished++;
+}
+
+void TelloSim::sendState()
+{
+    if(!sdkMode || !haveClient){
+        return;
+    }
+    // Body-frame velocity stands in for the tilt the drone would need.
+    double forward = std::cos(yaw) * velocity.x + std::sin(yaw) * velocity.y;
+    double left = -std::sin(yaw) * velocity.x + std::cos(yaw) * velocity.y;
+    int flight_s = mode == GROUNDED ? 0
+        : static_cast<int>(std::chrono::duration<double>(Clock::now() - flightStart).count());
+
+    char buf[256];
+    int len = snprintf(buf, sizeof(buf),
+        "mid:-1;x:0;y:0;z:0;mpry:0,0,0;pitch:%d;roll:%d;yaw:%d;vgx:%d;vgy:%d;vgz:%d;"
+        "templ:60;temph:62;tof:%d;h:%d;bat:%d;baro:%.2f;time:%d;agx:0.00;agy:0.00;agz:-1000.00;\r\n",
+        static_cast<int>(-forward * 10.0), static_cast<int>(-left * 10.0),
+        static_cast<int>(std::lround(-yaw * 180.0 / M_PI)),
+        static_cast<int>(velocity.x * 10.0), static_cast<int>(velocity.y * 10.0),
+        static_cast<int>(velocity.z * 10.0),
+        static_cast<int>(current.point.z * 100.0) + 10, static_cast<int>(current.point.z * 100.0),
+        battery, 100.0 + current.point.z, flight_s);
+
+    sockaddr_in stateAddress = client;
+    stateAddress.sin_port = htons(config.statePort);
+    sendto(socketfd, buf, len, 0, (struct sockaddr*)&stateAddress, sizeof(stateAddress));
+}
+
+void TelloSim::recordLoop(double ms)
+{
+    if(counters.loopSamples == 0){
+        counters.loopMax_ms = ms;
+    }
+    counters.loopMax_ms = std::max(counters.loopMax_ms, ms);
+    counters.loopSamples++;
+    counters.loopMean_ms += (ms - counters.loopMean_ms) / counters.loopSamples;
+}
@@ -0,0 +1,111 @@
+#ifndef TELLO_SIM_H
+#define TELLO_SIM_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <netinet/in.h>
+
+#include "EventLoop.hpp"
+#include "Messages.hpp"
+
+class vrpn_Connection;
+class vrpn_Tracker_Server;
+
+// Local stand-in for a Tello, for testing controllers without a drone.
+//
+// Speaks the SDK command set on a UDP port ("command", "takeoff", "land",
+// "rc a b c d", up/down/left/right/forward/back/cw/ccw, "speed", the common
+// "?" queries), pushes the 8890 state stream to whoever sent "command", and
+// integrates a point-mass model with a first-order velocity response. The
+// simulated pose is published as a VRPN tracker so the real mocap clients can
+// close the loop against it.
+//
+// It also measures the loop from the other side: every rc that arrives is
+// timed against the most recent pose publish, which gives the full
+// mocap -> controller -> drone latency as seen by the drone.
+class TelloSim{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config{
+        uint16_t commandPort;     // 8889 on a real drone
+        uint16_t statePort;       // where the state stream is sent
+        double physics_hz;
+        double mocap_hz;
+        double state_hz;
+        double maxSpeed;          // m/s at rc 100
+        double maxYawRate;        // rad/s at rc 100
+        double velocityTau;       // s, first-order velocity response
+        double takeoffHeight;     // m
+        double idleLand_s;        // the Tello lands after 15 s without commands
+
+        Config();
+    };
+
+    struct Stats{
+        uint64_t commands;
+        uint64_t rcReceived;
+        uint64_t posesPublished;
+        uint64_t loopSamples;
+        double loopMean_ms;       // pose publish -> next rc arrival
+        double loopMax_ms;
+    };
+
+    TelloSim(EventLoop& loop, vrpn_Connection* connection,
+             const char* trackerName = "Tracker0", const Config& config = Config());
+    ~TelloSim();
+
+    TelloSim(const TelloSim&) = delete;
+    TelloSim& operator=(const TelloSim&) = delete;
+
+    bool ok() const { return socketfd >= 0; }
+
+    const Pose_msg& pose() const { return current; }
+    bool flying() const { return mode != GROUNDED; }
+    const Stats& stats() const { return counters; }
+    void resetStats();
+
+private:
+    enum Mode{ GROUNDED, TAKING_OFF, LANDING, HOVERING, MOVING };
+
+    EventLoop& loop;
+    Config config;
+    vrpn_Connection* connection;
+    vrpn_Tracker_Server* tracker;
+    int socketfd;
+    int timers[3];
+
+    bool sdkMode;
+    sockaddr_in client;
+    bool haveClient;
+
+    Mode mode;
+    Pose_msg current;
+    double yaw;
+    Vector_3d velocity;
+    Vector_3d rcVelocity;         // body-frame setpoint from rc
+    double rcYawRate;
+    Vector_3d moveTarget;
+    double yawTarget;
+    double moveSpeed;             // m/s for movement commands
+    Clock::time_point lastCommand;
+    Clock::time_point flightStart;
+    Clock::time_point lastPosePublish;
+    bool rcSinceLastPose;
+    std::string pendingReply;     // sent when a move/takeoff/land completes
+    int battery;
+
+    Stats counters;
+
+    void onReadable();
+    void handleCommand(const std::string& cmd);
+    void reply(const std::string& text);
+    void finishMove();
+    void step(double dt);
+    void publishPose();
+    void sendState();
+    void recordLoop(double ms);
+};
+
+#endif //TELLO_SIM_H
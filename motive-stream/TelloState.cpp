@@ -0,0 +1,175 @@
+#include "TelloState.hpp"
+
+#include <cstring>
+
+// strtol/strtod need a NUL-terminated string and honour the locale; the
+// values in the state stream are short and plain, so parse them directly.
+static bool parseInt(const char*& p, const char* end, int32_t& out)
+{
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+')){
+        negative = *p == '-';
+        p++;
+    }
+    if(p >= end || *p < '0' || *p > '9'){
+        return false;
+    }
+    int32_t value = 0;
+    while(p < end && *p >= '0' && *p <= '9'){
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+static bool parseFloat(const char*& p, const char* end, float& out)
+{
+    bool negative = p < end && *p == '-';
+    int32_t whole;
+    if(!parseInt(p, end, whole)){
+        return false;
+    }
+    float value = static_cast<float>(negative ? -whole : whole);
+    if(p < end && *p == '.'){
+        p++;
+        float scale = 0.1f;
+        while(p < end && *p >= '0' && *p <= '9'){
+            value += (*p - '0') * scale;
+            scale *= 0.1f;
+            p++;
+        }
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+static bool parseShort(const char*& p, const char* end, int16_t& out)
+{
+    int32_t value;
+    if(!parseInt(p, end, value)){
+        return false;
+    }
+    out = static_cast<int16_t>(value);
+    return true;
+}
+
+static bool keyIs(const char* key, size_t keyLen, const char* name)
+{
+    return keyLen == strlen(name) && memcmp(key, name, keyLen) == 0;
+}
+
+bool parseTelloState(const char* data, size_t len, TelloState& state)
+{
+    const char* p = data;
+    const char* end = data + len;
+    state.fields = 0;
+
+    while(p < end){
+        // Skip separators and the trailing "\r\n"
+        if(*p == ';' || *p == '\r' || *p == '\n' || *p == ' '){
+            p++;
+            continue;
+        }
+        const char* key = p;
+        while(p < end && *p != ':'){
+            p++;
+        }
+        if(p >= end){
+            return false;
+        }
+        size_t keyLen = p - key;
+        p++; // ':'
+
+        bool ok = true;
+        switch(key[0]){
+        case 'm':
+            if(keyIs(key, keyLen, "mid")){
+                ok = parseShort(p, end, state.missionPad);
+                state.fields |= TelloState::MISSION_PAD;
+            }
+            else if(keyIs(key, keyLen, "mpry")){
+                ok = parseShort(p, end, state.padPitch) && p < end && *p++ == ','
+                     && parseShort(p, end, state.padRoll) && p < end && *p++ == ','
+                     && parseShort(p, end, state.padYaw);
+            }
+            break;
+        case 'x':
+            if(keyLen == 1) ok = parseShort(p, end, state.padX);
+            break;
+        case 'y':
+            if(keyLen == 1) ok = parseShort(p, end, state.padY);
+            else if(keyIs(key, keyLen, "yaw")){
+                ok = parseShort(p, end, state.yaw);
+                state.fields |= TelloState::ATTITUDE;
+            }
+            break;
+        case 'z':
+            if(keyLen == 1) ok = parseShort(p, end, state.padZ);
+            break;
+        case 'p':
+            if(keyIs(key, keyLen, "pitch")) ok = parseShort(p, end, state.pitch);
+            break;
+        case 'r':
+            if(keyIs(key, keyLen, "roll")) ok = parseShort(p, end, state.roll);
+            break;
+        case 'v':
+            if(keyIs(key, keyLen, "vgx")) ok = parseShort(p, end, state.vgx);
+            else if(keyIs(key, keyLen, "vgy")) ok = parseShort(p, end, state.vgy);
+            else if(keyIs(key, keyLen, "vgz")){
+                ok = parseShort(p, end, state.vgz);
+                state.fields |= TelloState::VELOCITY;
+            }
+            break;
+        case 't':
+            if(keyIs(key, keyLen, "templ")) ok = parseShort(p, end, state.tempLow);
+            else if(keyIs(key, keyLen, "temph")){
+                ok = parseShort(p, end, state.tempHigh);
+                state.fields |= TelloState::TEMPERATURE;
+            }
+            else if(keyIs(key, keyLen, "tof")){
+                ok = parseShort(p, end, state.tof);
+                state.fields |= TelloState::TOF;
+            }
+            else if(keyIs(key, keyLen, "time")){
+                ok = parseInt(p, end, state.motorTime);
+                state.fields |= TelloState::MOTOR_TIME;
+            }
+            break;
+        case 'h':
+            if(keyLen == 1){
+                ok = parseShort(p, end, state.height);
+                state.fields |= TelloState::HEIGHT;
+            }
+            break;
+        case 'b':
+            if(keyIs(key, keyLen, "bat")){
+                ok = parseShort(p, end, state.battery);
+                state.fields |= TelloState::BATTERY;
+            }
+            else if(keyIs(key, keyLen, "baro")){
+                ok = parseFloat(p, end, state.baro);
+                state.fields |= TelloState::BAROMETER;
+            }
+            break;
+        case 'a':
+            if(keyIs(key, keyLen, "agx")) ok = parseFloat(p, end, state.agx);
+            else if(keyIs(key, keyLen, "agy")) ok = parseFloat(p, end, state.agy);
+            else if(keyIs(key, keyLen, "agz")){
+                ok = parseFloat(p, end, state.agz);
+                state.fields |= TelloState::ACCELERATION;
+            }
+            break;
+        default:
+            break;
+        }
+        if(!ok){
+            return false;
+        }
+        // Skip anything left of the value (unknown keys, extra precision)
+        while(p < end && *p != ';'){
+            p++;
+        }
+    }
+    return (state.fields & TelloState::ATTITUDE) != 0;
+}
@@ -0,0 +1,53 @@
+#ifndef TELLO_STATE_H
+#define TELLO_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "StampedRing.hpp"
+
+// One datagram of the Tello state stream (UDP 8890, roughly 10 Hz):
+//   "mid:-1;x:0;y:0;z:0;mpry:0,0,0;pitch:0;roll:0;yaw:0;vgx:0;vgy:0;vgz:0;
+//    templ:0;temph:0;tof:10;h:0;bat:87;baro:-65.92;time:0;agx:0.00;
+//    agy:0.00;agz:-1000.00;\r\n"
+// SDK 1.3 firmware omits the mission-pad fields (mid, x, y, z, mpry).
+struct TelloState{
+    enum Field{
+        MISSION_PAD  = 1 << 0,  // mid, x, y, z, mpry
+        ATTITUDE     = 1 << 1,  // pitch, roll, yaw
+        VELOCITY     = 1 << 2,  // vgx, vgy, vgz
+        TEMPERATURE  = 1 << 3,  // templ, temph
+        TOF          = 1 << 4,
+        HEIGHT       = 1 << 5,
+        BATTERY      = 1 << 6,
+        BAROMETER    = 1 << 7,
+        MOTOR_TIME   = 1 << 8,
+        ACCELERATION = 1 << 9   // agx, agy, agz
+    };
+
+    uint32_t fields;            // Field bits seen in this datagram
+
+    int16_t missionPad;         // -1 when no pad is detected
+    int16_t padX, padY, padZ;   // cm, relative to the pad
+    int16_t padPitch, padRoll, padYaw;
+
+    int16_t pitch, roll, yaw;   // degrees
+    int16_t vgx, vgy, vgz;      // dm/s
+    int16_t tempLow, tempHigh;  // degrees C
+    int16_t tof;                // cm
+    int16_t height;             // cm, relative to takeoff
+    int16_t battery;            // percent
+    float baro;                 // m
+    int32_t motorTime;          // s
+    float agx, agy, agz;        // 0.001 g
+};
+
+// About six seconds of state at the Tello's ~10 Hz.
+using TelloStateRing = StampedRing<TelloState, 64>;
+
+// Parses one state datagram into state without allocating. Unknown keys are
+// skipped so newer firmware does not break the parser. Returns false if the
+// datagram is malformed or has no attitude.
+bool parseTelloState(const char* data, size_t len, TelloState& state);
+
+#endif //TELLO_STATE_H
@@ -0,0 +1,223 @@
+#include "TelloSwarm.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Granularity of command timeouts and of the deferred rc flush.
+static const uint32_t TICK_MS = 5;
+
+TelloSwarm::TelloSwarm(EventLoop& loop, uint16_t localPort, uint32_t minRcInterval_ms)
+    : loop(loop), socketfd(-1), tickTimer(-1), minRcInterval_ms(minRcInterval_ms), strays(0)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        std::cerr << "TelloSwarm: could not create socket" << std::endl;
+        return;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in localAddress;
+    memset(&localAddress, 0, sizeof(localAddress));
+    localAddress.sin_family = AF_INET;
+    localAddress.sin_port = htons(localPort);
+    localAddress.sin_addr.s_addr = INADDR_ANY;
+    if(bind(fd, (struct sockaddr*)&localAddress, sizeof(localAddress)) < 0){
+        std::cerr << "TelloSwarm: could not bind port " << localPort << std::endl;
+        close(fd);
+        return;
+    }
+
+    if(!loop.addReader(fd, [this]() { onReadable(); })){
+        close(fd);
+        return;
+    }
+    socketfd = fd;
+    tickTimer = loop.addTimer(TICK_MS, [this]() { onTick(); });
+}
+
+TelloSwarm::~TelloSwarm()
+{
+    if(tickTimer >= 0){
+        loop.cancelTimer(tickTimer);
+    }
+    if(socketfd >= 0){
+        loop.removeReader(socketfd);
+        close(socketfd);
+    }
+}
+
+uint64_t TelloSwarm::addressKey(const sockaddr_in& address)
+{
+    return (uint64_t(address.sin_addr.s_addr) << 16) | address.sin_port;
+}
+
+int TelloSwarm::addDrone(const std::string& ip, int32_t rigidBodyId, uint16_t port)
+{
+    std::unique_ptr<Drone> drone(new Drone());
+    memset(&drone->address, 0, sizeof(drone->address));
+    drone->address.sin_family = AF_INET;
+    drone->address.sin_port = htons(port);
+    if(inet_pton(AF_INET, ip.c_str(), &drone->address.sin_addr) != 1){
+        std::cerr << "TelloSwarm: bad drone address " << ip << std::endl;
+        return -1;
+    }
+    uint64_t key = addressKey(drone->address);
+    if(byAddress.count(key) || (rigidBodyId >= 0 && byRigidBody.count(rigidBodyId))){
+        std::cerr << "TelloSwarm: " << ip << " or rigid body " << rigidBodyId
+                  << " is already registered" << std::endl;
+        return -1;
+    }
+
+    int index = static_cast<int>(drones.size());
+    drone->name = ip + ":" + std::to_string(port);
+    drone->rigidBodyId = rigidBodyId;
+    Drone* raw = drone.get();
+    drone->commands.reset(new TelloCommandQueue([this, raw](const char* data, size_t len) {
+        return transmit(*raw, data, len);
+    }));
+    drone->rcPending = false;
+    drone->rcLen = 0;
+    drone->rcSent = 0;
+    drone->rcCoalesced = 0;
+
+    drones.push_back(std::move(drone));
+    byAddress[key] = index;
+    if(rigidBodyId >= 0){
+        byRigidBody[rigidBodyId] = index;
+    }
+    return index;
+}
+
+int TelloSwarm::droneForRigidBody(int32_t id) const
+{
+    auto it = byRigidBody.find(id);
+    return it == byRigidBody.end() ? -1 : it->second;
+}
+
+void TelloSwarm::routePose(const PoseSample& sample,
+                           const std::function<void(int, const PoseSample&)>& handler) const
+{
+    int drone = droneForRigidBody(sample.rigidBodyId);
+    if(drone >= 0){
+        handler(drone, sample);
+    }
+}
+
+uint32_t TelloSwarm::sendCommand(int drone, const std::string& cmd, ReplyCallback cb,
+                                 uint32_t timeout_ms, int retries)
+{
+    return drones[drone]->commands->push(cmd, std::move(cb), timeout_ms, retries);
+}
+
+void TelloSwarm::sendAll(const std::string& cmd,
+                         std::function<void(int, bool, const std::string&)> cb)
+{
+    for(size_t i = 0; i < drones.size(); i++){
+        int index = static_cast<int>(i);
+        ReplyCallback reply = nullptr;
+        if(cb){
+            reply = [cb, index](bool ok, const std::string& text) { cb(index, ok, text); };
+        }
+        drones[i]->commands->push(cmd, reply);
+    }
+}
+
+bool TelloSwarm::sendRc(int drone, int roll, int pitch, int throttle, int yaw)
+{
+    Drone& d = *drones[drone];
+    if(d.rcPending){
+        d.rcCoalesced++;
+    }
+    d.rcLen = snprintf(d.rcBuf, sizeof(d.rcBuf), "rc %d %d %d %d", roll, pitch, throttle, yaw);
+    d.rcPending = true;
+    return flushRc(d, Clock::now());
+}
+
+bool TelloSwarm::flushRc(Drone& drone, Clock::time_point now)
+{
+    if(!drone.rcPending){
+        return true;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - drone.lastRc);
+    if(elapsed.count() < minRcInterval_ms){
+        return true; // onTick() sends it once the interval has passed
+    }
+    drone.rcPending = false;
+    drone.lastRc = now;
+    if(!transmit(drone, drone.rcBuf, drone.rcLen)){
+        return false;
+    }
+    drone.rcSent++;
+    return true;
+}
+
+TelloSwarm::DroneStats TelloSwarm::stats(int drone) const
+{
+    const Drone& d = *drones[drone];
+    const TelloCommandQueue::Stats& queued = d.commands->stats();
+    DroneStats stats;
+    stats.commandsSent = queued.commandsSent;
+    stats.retries = queued.retries;
+    stats.timeouts = queued.timeouts;
+    stats.unmatchedReplies = queued.unmatchedReplies;
+    stats.lastQueuedSeq = queued.lastQueuedSeq;
+    stats.lastCompletedSeq = queued.lastCompletedSeq;
+    stats.rcSent = d.rcSent;
+    stats.rcCoalesced = d.rcCoalesced;
+    return stats;
+}
+
+bool TelloSwarm::transmit(const Drone& drone, const char* data, size_t len)
+{
+    if(socketfd < 0){
+        return false;
+    }
+    ssize_t bytes_sent = sendto(socketfd, data, len, 0,
+                                (struct sockaddr*)&drone.address, sizeof(drone.address));
+    if(bytes_sent < 0){
+        if(errno != EAGAIN && errno != EWOULDBLOCK){
+            std::cerr << "TelloSwarm: sendto " << drone.name << " failed: "
+                      << strerror(errno) << std::endl;
+        }
+        return false;
+    }
+    return true;
+}
+
+void TelloSwarm::onReadable()
+{
+    char buf[1024];
+    while(true){
+        sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        ssize_t bytes_recv = recvfrom(socketfd, buf, sizeof(buf) - 1, 0,
+                                      (struct sockaddr*)&from, &fromlen);
+        if(bytes_recv < 0){
+            return; // drained (EAGAIN) or transient error
+        }
+        auto it = byAddress.find(addressKey(from));
+        if(it == byAddress.end()){
+            strays++;
+            continue;
+        }
+        while(bytes_recv > 0 && (buf[bytes_recv - 1] == '\n' || buf[bytes_recv - 1] == '\r')){
+            bytes_recv--;
+        }
+        drones[it->second]->commands->onReply(std::string(buf, bytes_recv));
+    }
+}
+
+void TelloSwarm::onTick()
+{
+    Clock::time_point now = Clock::now();
+    for(auto& drone : drones){
+        drone->commands->onTick(now);
+        flushRc(*drone, now);
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef TELLO_SWARM_H
+#define TELLO_SWARM_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+
+#include "EventLoop.hpp"
+#include "PoseSource.hpp"
+#include "TelloCommandQueue.hpp"
+
+// Drives N Tellos in station mode (each joined to the same access point with
+// "ap <ssid> <pass>") from a single UDP socket on one EventLoop.
+//
+// Replies are demultiplexed by source address into per-drone command queues,
+// so a drone that is slow to acknowledge never holds up the others. rc
+// setpoints are rate limited per drone: a setpoint that arrives inside the
+// minimum interval replaces any earlier unsent one and goes out when the
+// interval expires (latest wins, nothing piles up).
+class TelloSwarm{
+public:
+    using Clock = std::chrono::steady_clock;
+    using ReplyCallback = TelloCommandQueue::ReplyCallback;
+
+    struct DroneStats{
+        uint64_t commandsSent;
+        uint64_t retries;
+        uint64_t timeouts;
+        uint64_t unmatchedReplies;
+        uint32_t lastQueuedSeq;
+        uint32_t lastCompletedSeq;
+        uint64_t rcSent;
+        uint64_t rcCoalesced;  // setpoints superseded before they were sent
+    };
+
+    explicit TelloSwarm(EventLoop& loop, uint16_t localPort = 8889,
+                        uint32_t minRcInterval_ms = 20);
+    ~TelloSwarm();
+
+    TelloSwarm(const TelloSwarm&) = delete;
+    TelloSwarm& operator=(const TelloSwarm&) = delete;
+
+    bool ok() const { return socketfd >= 0; }
+
+    // Registers a drone and the mocap rigid body that tracks it (-1 for
+    // none). Returns its index, or -1 if the address is bad or already used.
+    int addDrone(const std::string& ip, int32_t rigidBodyId, uint16_t port = 8889);
+
+    size_t size() const { return drones.size(); }
+    const std::string& name(int drone) const { return drones[drone]->name; }
+    int32_t rigidBodyId(int drone) const { return drones[drone]->rigidBodyId; }
+
+    // Returns the drone tracked by rigid body id, or -1.
+    int droneForRigidBody(int32_t id) const;
+
+    // Calls handler(drone, sample) if the sample's rigid body belongs to a drone.
+    void routePose(const PoseSample& sample,
+                   const std::function<void(int, const PoseSample&)>& handler) const;
+
+    // Per-drone equivalents of TelloEngine::sendCommand()/sendRc(). An rc
+    // setpoint inside minRcInterval_ms of the last one is held back for the
+    // tick timer, so false only means this call's datagram was refused.
+    uint32_t sendCommand(int drone, const std::string& cmd, ReplyCallback cb = nullptr,
+                         uint32_t timeout_ms = 0, int retries = -1);
+    bool sendRc(int drone, int roll, int pitch, int throttle, int yaw);
+
+    // Queues cmd on every drone; cb runs once per drone with its index.
+    void sendAll(const std::string& cmd,
+                 std::function<void(int, bool, const std::string&)> cb = nullptr);
+
+    void clearQueue(int drone) { drones[drone]->commands->clear(); }
+    size_t pending(int drone) const { return drones[drone]->commands->size(); }
+    DroneStats stats(int drone) const;
+
+    // Datagrams from addresses that are not registered drones.
+    uint64_t strayDatagrams() const { return strays; }
+
+private:
+    struct Drone{
+        std::string name;
+        sockaddr_in address;
+        int32_t rigidBodyId;
+        std::unique_ptr<TelloCommandQueue> commands;
+        Clock::time_point lastRc;
+        bool rcPending;
+        char rcBuf[32];
+        int rcLen;
+        uint64_t rcSent;
+        uint64_t rcCoalesced;
+    };
+
+    EventLoop& loop;
+    int socketfd;
+    int tickTimer;
+    uint32_t minRcInterval_ms;
+    std::vector<std::unique_ptr<Drone>> drones;
+    std::unordered_map<uint64_t, int> byAddress;
+    std::unordered_map<int32_t, int> byRigidBody;
+    uint64_t strays;
+
+    static uint64_t addressKey(const sockaddr_in& address);
+    bool transmit(const Drone& drone, const char* data, size_t len);
+    bool flushRc(Drone& drone, Clock::time_point now); // false if the send failed
+    void onReadable();
+    void onTick();
+};
+
+#endif //TELLO_SWARM_H
@@ -0,0 +1,121 @@
+#include "TelloTelemetry.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+TelloTelemetry::TelloTelemetry(EventLoop& loop, uint16_t port, size_t maxDrones)
+    : loop(loop), socketfd(-1), maxDrones(maxDrones), badDatagrams(0), strays(0)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0){
+        std::cerr << "TelloTelemetry: could not create socket" << std::endl;
+        return;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in localAddress;
+    memset(&localAddress, 0, sizeof(localAddress));
+    localAddress.sin_family = AF_INET;
+    localAddress.sin_port = htons(port);
+    localAddress.sin_addr.s_addr = INADDR_ANY;
+    if(bind(fd, (struct sockaddr*)&localAddress, sizeof(localAddress)) < 0){
+        std::cerr << "TelloTelemetry: could not bind port " << port << std::endl;
+        close(fd);
+        return;
+    }
+    if(!loop.addReader(fd, [this]() { onReadable(); })){
+        close(fd);
+        return;
+    }
+    socketfd = fd;
+}
+
+TelloTelemetry::~TelloTelemetry()
+{
+    if(socketfd >= 0){
+        loop.removeReader(socketfd);
+        close(socketfd);
+    }
+}
+
+int TelloTelemetry::sourceFor(uint32_t address)
+{
+    auto it = byAddress.find(address);
+    if(it != byAddress.end()){
+        return it->second;
+    }
+    if(sources.size() >= maxDrones){
+        return -1;
+    }
+    std::unique_ptr<Source> source(new Source());
+    source->address = address;
+    int index = static_cast<int>(sources.size());
+    sources.push_back(std::move(source));
+    byAddress[address] = index;
+    return index;
+}
+
+int TelloTelemetry::addDrone(const std::string& ip)
+{
+    in_addr address;
+    if(inet_pton(AF_INET, ip.c_str(), &address) != 1){
+        std::cerr << "TelloTelemetry: bad drone address " << ip << std::endl;
+        return -1;
+    }
+    int drone = sourceFor(address.s_addr);
+    if(drone < 0){
+        std::cerr << "TelloTelemetry: no room for drone " << ip << std::endl;
+    }
+    return drone;
+}
+
+int TelloTelemetry::droneIndex(const std::string& ip) const
+{
+    in_addr address;
+    if(inet_pton(AF_INET, ip.c_str(), &address) != 1){
+        return -1;
+    }
+    auto it = byAddress.find(address.s_addr);
+    return it == byAddress.end() ? -1 : it->second;
+}
+
+const TelloState* TelloTelemetry::align(const TelloStateRing& ring, const PoseSample& pose,
+                                        Clock::duration maxSkew)
+{
+    return ring.nearest(pose.arrival, maxSkew);
+}
+
+void TelloTelemetry::onReadable()
+{
+    char buf[512];
+    while(true){
+        sockaddr_in from;
+        socklen_t fromlen = sizeof(from);
+        ssize_t bytes_recv = recvfrom(socketfd, buf, sizeof(buf), 0,
+                                      (struct sockaddr*)&from, &fromlen);
+        if(bytes_recv < 0){
+            return; // drained (EAGAIN) or transient error
+        }
+        Clock::time_point received = Clock::now();
+
+        int drone = sourceFor(from.sin_addr.s_addr);
+        if(drone < 0){
+            strays++;
+            continue;
+        }
+        TelloStateRing& ring = sources[drone]->ring;
+        TelloState& state = ring.claim();
+        if(!parseTelloState(buf, bytes_recv, state)){
+            badDatagrams++;
+            continue;
+        }
+        ring.commit(received);
+        if(onState){
+            onState(drone, state);
+        }
+    }
+}
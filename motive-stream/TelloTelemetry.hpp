@@ -0,0 +1,79 @@
+#ifndef TELLO_TELEMETRY_H
+#define TELLO_TELEMETRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "EventLoop.hpp"
+#include "PoseSource.hpp"
+#include "TelloState.hpp"
+
+// Receives the Tello state stream (UDP 8890) on an EventLoop. Each datagram
+// is parsed straight into its drone's TelloStateRing and stamped with the
+// same steady_clock as PoseSample::arrival, so onboard attitude can be
+// matched to mocap poses by receive time.
+//
+// All drones push to the same port, so one TelloTelemetry serves a whole
+// swarm; rings are keyed by source address. Anything on the LAN can send to
+// the port, so the number of rings is capped at maxDrones.
+class TelloTelemetry{
+public:
+    using Clock = std::chrono::steady_clock;
+    using StateHandler = std::function<void(int drone, const TelloState& state)>;
+
+    explicit TelloTelemetry(EventLoop& loop, uint16_t port = 8890, size_t maxDrones = 32);
+    ~TelloTelemetry();
+
+    TelloTelemetry(const TelloTelemetry&) = delete;
+    TelloTelemetry& operator=(const TelloTelemetry&) = delete;
+
+    bool ok() const { return socketfd >= 0; }
+
+    // Pre-registers a drone so its ring exists before the first datagram.
+    // Drones that are not registered get a ring on their first datagram
+    // while there is room; after that their datagrams are dropped.
+    // Returns the drone's index, or -1 for a bad address or a full table.
+    int addDrone(const std::string& ip);
+    int droneIndex(const std::string& ip) const;
+
+    size_t size() const { return sources.size(); }
+    const TelloStateRing& ring(int drone) const { return sources[drone]->ring; }
+
+    // Runs after each state is committed to its ring.
+    void setHandler(StateHandler handler) { onState = std::move(handler); }
+
+    uint64_t parseErrors() const { return badDatagrams; }
+    // Datagrams dropped because their sender did not fit in the table.
+    uint64_t strayDatagrams() const { return strays; }
+
+    // State received closest to the pose's arrival, or nullptr if none is
+    // within maxSkew. Both stamps include their own network delay, so this
+    // is alignment to within a WiFi hop, which is what the controller needs.
+    static const TelloState* align(const TelloStateRing& ring, const PoseSample& pose,
+                                   Clock::duration maxSkew = std::chrono::milliseconds(100));
+
+private:
+    struct Source{
+        uint32_t address;
+        TelloStateRing ring;
+    };
+
+    EventLoop& loop;
+    int socketfd;
+    size_t maxDrones;
+    std::vector<std::unique_ptr<Source>> sources;
+    std::unordered_map<uint32_t, int> byAddress;
+    StateHandler onState;
+    uint64_t badDatagrams;
+    uint64_t strays;
+
+    int sourceFor(uint32_t address);
+    void onReadable();
+};
+
+#endif //TELLO_TELEMETRY_H
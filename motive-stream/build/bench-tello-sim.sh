@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Runs tello-mocap-hold against tello-sim for a fixed time and prints the
+# loop statistics from both ends. Build both binaries first.
+
+set -e  # Exit on error
+
+cd ~/AIMSLab/motive-stream
+DURATION=${1:-20}
+
+bin/tello-sim 9889 3883 &
+SIM_PID=$!
+trap "kill $SIM_PID 2>/dev/null" EXIT
+sleep 1
+
+(sleep "$DURATION"; echo land) | bin/tello-mocap-hold Tracker0@localhost 0 127.0.0.1 9889
@@ -0,0 +1,8 @@
+#!/bin/bash
+
+set -e  # Exit on error
+
+cd ~/AIMSLab/motive-stream
+echo "Compiling udp-tello-async.cpp..."
+g++ -std=c++11 examples/udp-tello-async.cpp EventLoop.cpp TelloCommandQueue.cpp TelloEngine.cpp -o bin/udp-tello-async
+echo "Build complete!"
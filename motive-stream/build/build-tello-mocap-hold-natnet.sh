@@ -0,0 +1,13 @@
+#!/bin/bash
+
+set -e  # Exit on error
+
+cd ~/AIMSLab/motive-stream
+echo "Building libvrpn..."
+cmake -S dependencies/vrpn -B dependencies/vrpn/build -DVRPN_BUILD_CLIENTS=OFF -DVRPN_BUILD_SERVERS=OFF > /dev/null
+cmake --build dependencies/vrpn/build --target vrpn -j"$(nproc)"
+echo "Compiling tello-mocap-hold.cpp against NatNet..."
+export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:$(pwd)/dependencies/NatNet/lib
+g++ -std=c++11 -DTELLO_WITH_NATNET examples/tello-mocap-hold.cpp EventLoop.cpp TelloCommandQueue.cpp TelloEngine.cpp TelloController.cpp PoseSource.cpp NatNetPoseSource.cpp TelloState.cpp TelloTelemetry.cpp \
+    -Idependencies/vrpn/ -Idependencies/vrpn/build/ -Idependencies/NatNet/include/ dependencies/vrpn/build/libvrpn.a -Ldependencies/NatNet/lib/ -lNatNet -lpthread -o bin/tello-mocap-hold-natnet
+echo "Build complete!"
@@ -0,0 +1,12 @@
+#!/bin/bash
+
+set -e  # Exit on error
+
+cd ~/AIMSLab/motive-stream
+echo "Building libvrpn..."
+cmake -S dependencies/vrpn -B dependencies/vrpn/build -DVRPN_BUILD_CLIENTS=OFF -DVRPN_BUILD_SERVERS=OFF > /dev/null
+cmake --build dependencies/vrpn/build --target vrpn -j"$(nproc)"
+echo "Compiling tello-mocap-hold.cpp..."
+g++ -std=c++11 examples/tello-mocap-hold.cpp EventLoop.cpp TelloCommandQueue.cpp TelloEngine.cpp TelloController.cpp PoseSource.cpp TelloState.cpp TelloTelemetry.cpp \
+    -Idependencies/vrpn/ -Idependencies/vrpn/build/ dependencies/vrpn/build/libvrpn.a -lpthread -o bin/tello-mocap-hold
+echo "Build complete!"
@@ -0,0 +1,12 @@
+#!/bin/bash
+
+set -e  # Exit on error
+
+cd ~/AIMSLab/motive-stream
+echo "Building libvrpn..."
+cmake -S dependencies/vrpn -B dependencies/vrpn/build -DVRPN_BUILD_CLIENTS=OFF -DVRPN_BUILD_SERVERS=OFF > /dev/null
+cmake --build dependencies/vrpn/build --target vrpn -j"$(nproc)"
+echo "Compiling tello-sim.cpp..."
+g++ -std=c++11 examples/tello-sim.cpp EventLoop.cpp TelloSim.cpp \
+    -Idependencies/vrpn/ -Idependencies/vrpn/build/ dependencies/vrpn/build/libvrpn.a -lpthread -o bin/tello-sim
+echo "Build complete!"
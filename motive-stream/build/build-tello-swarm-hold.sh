@@ -0,0 +1,12 @@
+#!/bin/bash
+
+set -e  # Exit on error
+
+cd ~/AIMSLab/motive-stream
+echo "Building libvrpn..."
+cmake -S dependencies/vrpn -B dependencies/vrpn/build -DVRPN_BUILD_CLIENTS=OFF -DVRPN_BUILD_SERVERS=OFF > /dev/null
+cmake --build dependencies/vrpn/build --target vrpn -j"$(nproc)"
+echo "Compiling tello-swarm-hold.cpp..."
+g++ -std=c++11 examples/tello-swarm-hold.cpp EventLoop.cpp TelloCommandQueue.cpp TelloSwarm.cpp TelloEngine.cpp TelloController.cpp PoseSource.cpp \
+    -Idependencies/vrpn/ -Idependencies/vrpn/build/ dependencies/vrpn/build/libvrpn.a -lpthread -o bin/tello-swarm-hold
+echo "Build complete!"
@@ -5,9 +5,10 @@
 
 #include "vrpn_BaseClass.h"  // for vrpn_Callback_List, etc
 #include "vrpn_Configure.h"  // for VRPN_API, VRPN_CALLBACK
-#include "vrpn_Connection.h" // for vrpn_CONNECTION_LOW_LATENCY, etc
-#include "vrpn_Shared.h"     // for timeval
-#include "vrpn_Types.h"      // for vrpn_int32, vrpn_float64, etc
+#include "vrpn_Connection.h"    // for vrpn_CONNECTION_LOW_LATENCY, etc
+#include "vrpn_MessageSchema.h" // for vrpn_Schema, vrpn_SchemaTail, etc
+#include "vrpn_Shared.h"        // for timeval
+#include "vrpn_Types.h"         // for vrpn_int32, vrpn_float64, etc
 
 #ifndef VRPN_CLIENT_ONLY
 #include "vrpn_Serial.h" // for ::vrpn_SER_PARITY_NONE, etc
@@ -15,6 +16,18 @@
 
 #define vrpn_CHANNEL_MAX 128
 
+// Wire layout of the channel message, packed and unpacked with
+// vrpn_buffer_message()/vrpn_unbuffer_message().  The channel count goes
+// as a vrpn_float64, and only the first num_channel channels are sent.
+struct vrpn_ANALOGMSG {
+    vrpn_float64 num_channel;
+    vrpn_float64 channel[vrpn_CHANNEL_MAX];
+};
+typedef vrpn_Schema<
+    vrpn_SchemaField<vrpn_float64>,
+    vrpn_Schema<vrpn_SchemaTail<vrpn_float64, vrpn_CHANNEL_MAX> > >
+    vrpn_ANALOGSCHEMA;
+
 // analog status flags
 const int vrpn_ANALOG_SYNCING = (2);
 const int vrpn_ANALOG_REPORT_READY = (1);
@@ -2,9 +2,10 @@
 #include <stddef.h> // for NULL
 
 #include "vrpn_BaseClass.h" // for vrpn_Callback_List, etc
-#include "vrpn_Configure.h" // for VRPN_API, VRPN_CALLBACK
-#include "vrpn_Shared.h"    // for timeval
-#include "vrpn_Types.h"     // for vrpn_int32, vrpn_float64, etc
+#include "vrpn_Configure.h"     // for VRPN_API, VRPN_CALLBACK
+#include "vrpn_MessageSchema.h" // for vrpn_Schema, vrpn_SchemaField, etc
+#include "vrpn_Shared.h"        // for timeval
+#include "vrpn_Types.h"         // for vrpn_int32, vrpn_float64, etc
 
 class VRPN_API vrpn_Connection;
 struct vrpn_HANDLERPARAM;
@@ -12,6 +13,24 @@ struct vrpn_HANDLERPARAM;
 const int vrpn_BUTTON_MAX_BUTTONS = 256;
 const int VRPN_BUTTON_BUF_SIZE = 256;
 
+// Wire layouts of the change and states messages, packed and unpacked with
+// vrpn_buffer_message()/vrpn_unbuffer_message().  Only the first
+// num_buttons states are sent.
+struct vrpn_BUTTONCHANGEMSG {
+    vrpn_int32 button;
+    vrpn_int32 state;
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_int32, 2> > vrpn_BUTTONCHANGESCHEMA;
+
+struct vrpn_BUTTONSTATESMSG {
+    vrpn_int32 num_buttons;
+    vrpn_int32 states[vrpn_BUTTON_MAX_BUTTONS];
+};
+typedef vrpn_Schema<
+    vrpn_SchemaField<vrpn_int32>,
+    vrpn_Schema<vrpn_SchemaTail<vrpn_int32, vrpn_BUTTON_MAX_BUTTONS> > >
+    vrpn_BUTTONSTATESSCHEMA;
+
 // Base class for buttons.  Definition
 // of remote button class for the user is at the end.
 
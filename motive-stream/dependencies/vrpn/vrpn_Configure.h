@@ -48,6 +48,48 @@
 // Use Winsock2 library rather than Winsock.
 //#define	VRPN_USE_WINSOCK2
 
+//-----------------------
+// On Linux, have vrpn_Connection_IP::mainloop() wait on all of its
+// sockets with a single epoll_wait() rather than one select() per
+// endpoint.  Ignored on other platforms.
+#define VRPN_USE_EPOLL
+
+//-----------------------
+// On Linux, read incoming UDP datagrams in batches with recvmmsg()
+// rather than one select() and recv() per datagram.  Ignored on other
+// platforms.
+#define VRPN_USE_RECVMMSG
+
+//-----------------------
+// On Linux, read incoming TCP in large non-blocking chunks and hand out
+// every complete message in each one, rather than doing a select() and
+// two or three blocking reads per message.  Ignored on other platforms.
+#define VRPN_USE_BUFFERED_TCP
+
+//-----------------------
+// On Linux, send the pending UDP reports for all of a server's clients
+// with one sendmmsg() per mainloop() rather than one send() per client.
+// Ignored on other platforms.
+#define VRPN_USE_SENDMMSG
+
+//-----------------------
+// On Linux, let vrpn_Connection::set_arrival_timestamps() turn on
+// SO_TIMESTAMPNS so that handlers see when each message reached the
+// host's kernel.  Needs VRPN_USE_RECVMMSG.  Ignored on other platforms.
+#define VRPN_USE_RX_TIMESTAMPS
+
+//-----------------------
+// On Linux, let vrpn_Connection::set_endpoint_shards() spread the sending
+// to connected clients over worker threads.  Needs VRPN_USE_EPOLL.
+// Ignored on other platforms.
+#define VRPN_USE_ENDPOINT_SHARDS
+
+//-----------------------
+// On Linux, let a client and server on the same host move their messages
+// through a pair of shared-memory rings rather than TCP and UDP.  Used for
+// "shm:" connection names and for localhost.  Ignored on other platforms.
+#define VRPN_USE_SHARED_MEMORY
+
 //-----------------------
 // Instructs VRPN to expose the vrpn_gettimeofday() function also
 // as gettimeofday() so that external programs can use it.  This
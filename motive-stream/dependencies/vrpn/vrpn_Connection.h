@@ -11,6 +11,41 @@
 #include <sys/select.h> // for fd_set
 #endif
 
+// vrpn_Connection_IP::mainloop() waits on every socket with one epoll_wait()
+#if defined(VRPN_USE_EPOLL) && defined(__linux__)
+#define vrpn_CONNECTION_USE_EPOLL
+#endif
+
+// vrpn_Endpoint_IP::handle_udp_messages() reads datagrams with recvmmsg()
+#if defined(VRPN_USE_RECVMMSG) && defined(__linux__)
+#define vrpn_CONNECTION_USE_RECVMMSG
+#endif
+
+// vrpn_Endpoint_IP reads TCP in large chunks and parses messages out of them
+#if defined(VRPN_USE_BUFFERED_TCP) && defined(__linux__)
+#define vrpn_CONNECTION_USE_TCP_STREAM
+#endif
+
+// vrpn_Connection_IP sends UDP to all of its endpoints with sendmmsg()
+#if defined(VRPN_USE_SENDMMSG) && defined(__linux__)
+#define vrpn_CONNECTION_USE_SENDMMSG
+#endif
+
+// vrpn_Endpoint_IP can ask the kernel to timestamp incoming messages
+#if defined(VRPN_USE_RX_TIMESTAMPS) && defined(vrpn_CONNECTION_USE_RECVMMSG)
+#define vrpn_CONNECTION_USE_RX_TIMESTAMPS
+#endif
+
+// vrpn_Connection_IP can send to its clients from worker threads
+#if defined(VRPN_USE_ENDPOINT_SHARDS) && defined(vrpn_CONNECTION_USE_EPOLL)
+#define vrpn_CONNECTION_USE_SHARDS
+#endif
+
+// vrpn_Endpoint_IP can talk to a peer on the same host through shared memory
+#if defined(VRPN_USE_SHARED_MEMORY) && defined(__linux__)
+#define vrpn_CONNECTION_USE_SHM
+#endif
+
 struct timeval;
 
 // Don't complain about using sprintf() when using Visual Studio.
@@ -47,6 +82,11 @@ struct vrpn_HANDLERPARAM {
     struct timeval msg_time;
     vrpn_int32 payload_len;
     const char *buffer;
+    /// When the packet carrying the message reached this host, stamped by
+    /// the kernel on the same clock as vrpn_gettimeofday().  Zero unless
+    /// vrpn_Connection::set_arrival_timestamps() is on and the message
+    /// came over the network.
+    struct timeval arrival_time;
 };
 
 /// @brief Type of a message handler for vrpn_Connection messages.
@@ -62,10 +102,9 @@ typedef vrpn_MESSAGEHANDLER vrpn_LOGFILTER;
 /// access.
 const unsigned vrpn_ALIGN = 8;
 
-/// Types now have their storage dynamically allocated, so we can afford
-/// to have large tables.  We need at least 150-200 for the microscope
-/// project as of Jan 98, and will eventually need two to three times that
-/// number.
+/// vrpn_Connection grows its sender and type tables as they fill, so these
+/// no longer limit a connection.  They remain for code that keeps its own
+/// per-type arrays, such as vrpn_RedundantReceiver.
 /// @{
 const int vrpn_CONNECTION_MAX_SENDERS = 2000;
 const int vrpn_CONNECTION_MAX_TYPES = 2000;
@@ -88,19 +127,91 @@ const int vrpn_ANY_TYPE = -1;
 /// UDP is set based on Ethernet maximum transmission size;  trying
 /// to send a message via UDP which is longer than the MTU of any
 /// intervening physical network may cause untraceable failures,
-/// so for now we do not expose any way to change the UDP output
-/// buffer size.  (MTU = 1500 bytes, - 28 bytes of IP+UDP header)
+/// so vrpn_Connection::set_udp_payload_size() should only be used to
+/// raise it on networks known to carry jumbo frames end to end.
+/// (MTU = 1500 bytes, - 28 bytes of IP+UDP header)
 /// @{
 
 const int vrpn_CONNECTION_TCP_BUFLEN = 64000;
+/// Bytes each message's header takes in either buffer, ahead of its
+/// payload (which is padded to a multiple of vrpn_ALIGN).
+const int vrpn_CONNECTION_HEADER_LEN = 24;
 const int vrpn_CONNECTION_UDP_BUFLEN = 1472;
+/// Largest UDP payload that can be configured (9000-byte jumbo frames).
+/// Incoming UDP buffers are always this big, so one end can raise its
+/// payload size without the other having to know.
+const int vrpn_CONNECTION_UDP_MAX_BUFLEN = 8972;
+/// Smallest UDP payload that can be configured.
+const int vrpn_CONNECTION_UDP_MIN_BUFLEN = 512;
+/// Most datagrams pulled in by one recvmmsg() call.
+const int vrpn_CONNECTION_UDP_BATCH = 16;
+/// Bytes of incoming TCP stream buffered under VRPN_USE_BUFFERED_TCP.
+/// Must hold the largest message with its header and a good chunk more.
+const int vrpn_CONNECTION_TCP_STREAM_BUFLEN = 128 * 1024;
+/// @}
+
+/// @name Priority classes for reliable (TCP) messages
+/// See vrpn_Connection::set_type_priority().  Each class has its own
+/// outgoing buffer of vrpn_CONNECTION_TCP_BUFLEN bytes.
+/// @{
+const int vrpn_CONNECTION_PRIORITY_CONTROL = 0; ///< System messages, commands
+const int vrpn_CONNECTION_PRIORITY_REPORT = 1;  ///< Device reports (default)
+const int vrpn_CONNECTION_PRIORITY_BULK = 2;    ///< Images and other bulk data
+const int vrpn_CONNECTION_PRIORITIES = 3;
+/// Bulk messages are only handed to a TCP socket while it has fewer than
+/// this many bytes not yet sent, so that reports never queue behind much.
+const int vrpn_CONNECTION_TCP_BULK_UNSENT = 32 * 1024;
+/// @}
+
+/// @name When queued vrpn_CONNECTION_LOW_LATENCY (UDP) messages are sent
+/// See vrpn_Connection::set_udp_flush_policy().
+/// @{
+const int vrpn_CONNECTION_UDP_FLUSH_MAINLOOP = 0;  ///< Once per mainloop()
+const int vrpn_CONNECTION_UDP_FLUSH_IMMEDIATE = 1; ///< As each is packed
+const int vrpn_CONNECTION_UDP_FLUSH_COALESCE = 2;  ///< When full or late
 /// @}
 
+/// @name Reconnection backoff
+/// A client whose server does not answer lobs its next request, or starts
+/// its next TCP connect, after the minimum delay, doubling the delay after
+/// each attempt that fails up to the maximum.  A connect that has not
+/// finished by the time the next attempt is due is abandoned.
+/// @{
+const int vrpn_CONNECTION_RETRY_MIN_MSECS = 1000;
+const int vrpn_CONNECTION_RETRY_MAX_MSECS = 16000;
+/// @}
+
+/// Most sender/type pairs that vrpn_Connection::set_alternate_type() holds.
+/// Each is a bit in vrpn_Endpoint::d_peerAlternates.
+const int vrpn_CONNECTION_MAX_ALTERNATES = 32;
+
+/// Most sender/type pairs that vrpn_Connection::set_latest_only() holds.
+const int vrpn_CONNECTION_MAX_LATEST_ONLY = 32;
+
 /// @brief Number of endpoints that a server connection can have.  Arbitrary
 /// limit.
 
 const int vrpn_MAX_ENDPOINTS = 256;
 
+/// @name Worker threads for vrpn_Connection::set_endpoint_shards()
+/// @{
+const int vrpn_CONNECTION_MAX_SHARDS = 64;
+/// Bytes of marshalled messages that can wait for the workers.  The
+/// largest message that can be sent to sharded endpoints is a quarter
+/// of this.
+const int vrpn_CONNECTION_SHARD_QUEUE_BYTES = 1 << 22;
+/// A sharded client whose TCP socket takes nothing for this long is
+/// dropped, so that it can't hold up the workers' queue.
+const int vrpn_CONNECTION_SHARD_SEND_TIMEOUT_USEC = 500000;
+/// How long pack_message() waits for room on a full queue before it
+/// gives up on the message.
+const int vrpn_CONNECTION_SHARD_QUEUE_WAIT_USEC = 1000000;
+/// @}
+
+/// Bytes in each direction's ring when two endpoints on the same host
+/// talk through shared memory.  A power of two.
+const int vrpn_CONNECTION_SHM_RING_BYTES = 1 << 20;
+
 /// @name System message types
 /// @{
 const vrpn_int32 vrpn_CONNECTION_SENDER_DESCRIPTION = (-1);
@@ -108,6 +219,9 @@ const vrpn_int32 vrpn_CONNECTION_TYPE_DESCRIPTION = (-2);
 const vrpn_int32 vrpn_CONNECTION_UDP_DESCRIPTION = (-3);
 const vrpn_int32 vrpn_CONNECTION_LOG_DESCRIPTION = (-4);
 const vrpn_int32 vrpn_CONNECTION_DISCONNECT_MESSAGE = (-5);
+const vrpn_int32 vrpn_CONNECTION_SHM_DESCRIPTION = (-6);
+const vrpn_int32 vrpn_CONNECTION_ALTERNATE_DESCRIPTION = (-7);
+const vrpn_int32 vrpn_CONNECTION_MULTICAST_DESCRIPTION = (-8);
 /// @}
 
 /// Classes of service for messages, specify multiple by ORing them together
@@ -178,6 +292,28 @@ struct vrpnMsgCallbackEntry {
     vrpnMsgCallbackEntry *next;  ///< Next handler
 };
 
+/// @brief What one endpoint has sent over UDP.  The counters wrap.
+struct vrpn_UDPStats {
+    vrpn_uint32 datagrams;             ///< Datagrams sent
+    vrpn_uint32 messages;              ///< Messages carried in them
+    vrpn_uint32 bytes;                 ///< Payload bytes carried in them
+    vrpn_uint32 maxMessagesPerDatagram;
+};
+
+/// @brief What one priority class of an endpoint's reliable messages has
+/// been through.  The counters wrap.
+struct vrpn_TCPQueueStats {
+    vrpn_uint32 messages;  ///< Messages packed
+    vrpn_uint32 bytes;     ///< Bytes packed, with headers
+    vrpn_uint32 maxQueued; ///< Most bytes waiting to be sent at once
+    vrpn_uint32 stalls;    ///< Times packing found the buffer full and
+                           ///< had to wait for the socket to take it
+    vrpn_uint32 stallUsec; ///< Time spent waiting in those
+    vrpn_uint32 deferred;  ///< Times the socket was too busy to take all
+                           ///< of it (bulk messages only), leaving the
+                           ///< rest for the next mainloop()
+};
+
 struct vrpnLogFilterEntry {
     vrpn_LOGFILTER filter; ///< routine to call
     void *userdata;        ///< passed along
@@ -189,6 +325,16 @@ class VRPN_API vrpn_Connection;
 class VRPN_API vrpn_Log;
 class VRPN_API vrpn_TranslationTable;
 class VRPN_API vrpn_TypeDispatcher;
+class vrpn_EndpointShards;
+struct vrpn_EndpointShard;
+class vrpn_MulticastGroup;
+struct vrpn_ShmRing;
+
+/// A message type from a particular sender.
+struct vrpn_SenderType {
+    vrpn_int32 sender;
+    vrpn_int32 type;
+};
 
 /// @brief Encapsulation of the data and methods for a single generic connection
 /// to take care of one part of many clients talking to a single server.
@@ -213,6 +359,20 @@ public:
     /// Returns the local mapping for the remote sender (-1 if none).
     int local_sender_id(vrpn_int32 remote_sender) const;
 
+    /// Returns nonzero if the other side has said it reads messages of the
+    /// local type from the local sender in place of the usual ones; see
+    /// vrpn_Connection::accept_alternate_type().
+    vrpn_bool peer_accepts(vrpn_int32 sender, vrpn_int32 type) const;
+
+    /// The pairs behind peer_accepts(), in the order they were declared.
+    /// @{
+    int num_peer_accepts(void) const { return d_numPeerAccepts; }
+    const vrpn_SenderType &peer_accept(int which) const
+    {
+        return d_peerAccepts[which];
+    }
+    /// @}
+
     virtual vrpn_bool doing_okay(void) const = 0;
     /// @}
 
@@ -280,6 +440,14 @@ public:
     int pack_type_description(vrpn_int32 which);
     ///< Packs a type description.
 
+    int pack_alternate_description(vrpn_int32 sender, vrpn_int32 type);
+    ///< Tells the other side that we read messages of this type from
+    ///< this sender in place of the usual ones.
+
+    int dispatch_latest(void);
+    ///< Calls the handlers for the newest message of each stream that
+    ///< vrpn_Connection::set_latest_only() held back while reading.
+
     /// @}
     int status;
 
@@ -296,6 +464,15 @@ public:
     ///< for example.
     char rhostname[150];
 
+    /// Which of the connection's alternate types (see
+    /// vrpn_Connection::set_alternate_type()) the other side accepts, one
+    /// bit per pair.  Written only by the connection's thread.
+    vrpn_uint32 d_peerAlternates;
+
+    /// Messages that were held back as latest-only and then replaced by a
+    /// newer one from the same stream before being handled.
+    vrpn_uint32 d_latestDropped;
+
     /// @name Logging
     ///
     /// TCH 19 April 00;  changed into two logs 16 Feb 01
@@ -316,6 +493,8 @@ public:
     handle_sender_message(void *userdata, vrpn_HANDLERPARAM p);
     static int VRPN_CALLBACK
     handle_type_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_alternate_message(void *userdata, vrpn_HANDLERPARAM p);
     /// @}
 
     /// @name Routines to inform the endpoint of the connection of
@@ -329,6 +508,10 @@ protected:
     virtual int dispatch(vrpn_int32 type, vrpn_int32 sender, timeval time,
                          vrpn_uint32 payload_len, char *bufptr);
 
+    timeval d_arrivalTime;
+    ///< Kernel arrival time of the message being read, or zero;
+    ///< dispatch() hands it to the handlers.
+
     int tryToMarshall(char *outbuf, vrpn_int32 &buflen, vrpn_int32 &numOut,
                       vrpn_uint32 len, timeval time, vrpn_int32 type,
                       vrpn_int32 sender, const char *buffer,
@@ -352,6 +535,59 @@ protected:
     vrpn_TranslationTable *d_senders;
     vrpn_TranslationTable *d_types;
 
+    /// Alternate types the other side accepts, in local IDs.  Allocated
+    /// when the first one is declared, since most peers declare none.
+    vrpn_SenderType *d_peerAccepts;
+    int d_numPeerAccepts;
+    int d_maxPeerAccepts;
+    /// Open-addressed hash of d_peerAccepts, so that peer_accepts() does
+    /// not search them all;  2 * d_maxPeerAccepts slots, -1 free.
+    int *d_peerAcceptIndex;
+
+    int find_peer_accept(vrpn_int32 sender, vrpn_int32 type,
+                         int *slot) const;
+    ///< Returns the pair's index in d_peerAccepts, or -1 with *slot where
+    ///< it would go in d_peerAcceptIndex.
+    int add_peer_accept(vrpn_int32 sender, vrpn_int32 type);
+    ///< Returns -1 if there is no room and no memory for more.
+    bool grow_peer_accepts(void);
+    void clear_peer_accepts(void);
+
+    /// Newest message read so far from each latest-only stream, in the
+    /// order the streams turned up.  Buffers stay allocated between reads.
+    struct vrpn_LatestMessage {
+        vrpn_int32 type;   ///< Local ID
+        vrpn_int32 sender; ///< Local ID
+        vrpn_int32 key;
+        vrpn_int32 epoch;
+        int group;         ///< Entry with the newest epoch, or -1 if none
+        vrpn_bool isGroup; ///< This is that entry, and holds no message
+        int slot;          ///< Where d_latestIndex points to it, or -1
+        timeval time;
+        timeval arrival;
+        vrpn_uint32 len;
+        char *buffer;
+        vrpn_uint32 buflen;
+    };
+    vrpn_LatestMessage *d_latest;
+    int d_numLatest;
+    int d_maxLatest;
+    int *d_latestIndex; ///< Open-addressed, 2 * d_maxLatest slots, -1 free
+
+    int hold_latest(vrpn_int32 type, vrpn_int32 sender, vrpn_int32 key,
+                    vrpn_bool has_epoch, vrpn_int32 epoch, timeval time,
+                    vrpn_uint32 payload_len, const char *bufptr);
+    ///< Keeps a copy of the message in place of any older one from the
+    ///< same stream.  Returns 1 if it was kept or is stale, 0 if there's
+    ///< no room.
+    int find_latest(vrpn_int32 type, vrpn_int32 sender, vrpn_int32 key,
+                    vrpn_bool isGroup, int *slot) const;
+    ///< Returns the entry's index, or -1 with *slot where it would go.
+    int add_latest(int slot, vrpn_int32 type, vrpn_int32 sender,
+                   vrpn_int32 key, vrpn_bool isGroup);
+    bool grow_latest(void);
+    void clear_latest(void);
+
     vrpn_TypeDispatcher *d_dispatcher;
     vrpn_int32 *d_connectionCounter;
 
@@ -399,27 +635,91 @@ public:
                      vrpn_int32 sender, const char *buffer,
                      vrpn_uint32 class_of_service);
 
+    /// @brief Like pack_message(), but copies a message that has already
+    /// been marshalled (into frame, frame_len bytes long) and stamps in
+    /// this endpoint's sequence number.  This lets a connection marshal
+    /// a message once for all of its endpoints.  priority is the type's
+    /// vrpn_Connection::get_type_priority(), which a worker thread can't
+    /// look up itself.
+    int pack_marshalled(const char *frame, vrpn_uint32 frame_len,
+                        vrpn_uint32 len, struct timeval time,
+                        vrpn_int32 type, vrpn_int32 sender,
+                        const char *buffer, vrpn_uint32 class_of_service,
+                        int priority);
+
     /// @brief send pending report, clear the buffer.
     ///
     /// This function was protected, now is public, so we can use it
     /// to send out intermediate results without calling mainloop
     virtual int send_pending_reports(void);
 
+    int send_pending_tcp(vrpn_bool wait_for_bulk = vrpn_FALSE);
+    ///< The TCP half of send_pending_reports():  sends the TCP buffers
+    ///< highest priority first, leaving the UDP buffer alone.  Bulk
+    ///< messages go only as far as the socket takes them without
+    ///< waiting, unless wait_for_bulk.  Returns -1 and sets status to
+    ///< BROKEN on failure.
+
     int pack_udp_description(int portno);
 
     int handle_tcp_messages(const timeval *timeout);
     int handle_udp_messages(const timeval *timeout);
 
+    void update_rx_timestamps(void);
+    ///< Turns SO_TIMESTAMPNS on or off for the inbound sockets to match
+    ///< the connection's set_arrival_timestamps().  Makes no system calls
+    ///< unless the sockets or the setting have changed.
+
     int connect_tcp_to(const char *msg);
     int connect_tcp_to(const char *addr, int port);
-    ///< Connects d_tcpSocket to the specified address (msg = "IP port");
-    ///< sets status to COOKIE_PENDING;  returns 0 on success, -1 on failure
+    ///< Starts connecting d_tcpSocket to the specified address (msg = "IP
+    ///< port") without waiting.  Sets status to COOKIE_PENDING if the
+    ///< connect finished at once;  otherwise leaves tcp_connecting() true
+    ///< for poll_for_connect() to finish.  Returns 0 on success, -1 on
+    ///< failure.
+    int poll_for_connect(void);
+    ///< Checks, without waiting, on a connect started by connect_tcp_to().
+    ///< Returns 1 once it has finished (status is then COOKIE_PENDING),
+    ///< 0 while it is still going, and -1 if it failed or ran out of time,
+    ///< in which case the socket has been closed.
+    vrpn_bool tcp_connecting(void) const { return d_tcpConnecting; }
     int connect_udp_to(const char *addr, int port);
     ///< Connects d_udpSocket to the specified address and port;
     ///< returns 0 on success, sets status to BROKEN and returns -1
     ///< on failure.
 
     vrpn_int32 set_tcp_outbuf_size(vrpn_int32 bytecount);
+    vrpn_int32 set_udp_outbuf_size(vrpn_int32 bytecount);
+    ///< Both return the new size, or -1 if out of memory.  Anything
+    ///< already packed is kept, or sent first if it would not fit.
+
+    int send_due_reports(const timeval &now);
+    ///< What mainloop() sends:  like send_pending_reports(), except
+    ///< that under vrpn_CONNECTION_UDP_FLUSH_COALESCE the UDP buffer is
+    ///< left to fill until udp_held() says it has waited long enough.
+
+    vrpn_bool udp_held(const timeval &now, timeval *remaining = NULL) const;
+    ///< True if the UDP buffer is being held back for coalescing; if so,
+    ///< remaining is set to how much longer it will be held.
+
+    vrpn_bool retry_held(const timeval &now, timeval *remaining = NULL) const;
+    ///< True if a TRYING_TO_CONNECT endpoint has nothing to do but wait on
+    ///< its sockets until its next attempt is due or its connect runs out
+    ///< of time;  if so, remaining is set to how long that is.
+
+    void note_connect_attempt(const timeval &now);
+    ///< Records a UDP request or TCP connect sent at now, and doubles the
+    ///< delay before the next one (see vrpn_CONNECTION_RETRY_MIN_MSECS).
+
+    void note_udp_sent(void);
+    ///< Adds the UDP buffer to the counters;  call once it has been sent
+    ///< and before clearBuffers().
+
+    const vrpn_UDPStats &udp_stats(void) const { return d_udpStats; }
+    const vrpn_TCPQueueStats &tcp_stats(int priority) const
+    {
+        return d_tcpStats[priority];
+    }
 
     int setup_new_connection(void);
     ///< Sends the magic cookie and other information to its
@@ -437,8 +737,122 @@ public:
     ///< Empties out the TCP and UDP send buffers.
     ///< Needed by vrpn_FileConnection to get at {udp,tcp}NumOut.
 
+    void clearUDPBuffer(void);
+    ///< Empties out the UDP send buffer once it has been sent.
+
     void setNICaddress(const char *);
 
+    int handle_incoming(vrpn_bool tcp_ready, vrpn_bool udp_ready);
+    ///< Reads whatever is waiting on the channels marked ready.  This is
+    ///< the receive half of mainloop() for a CONNECTED endpoint, for
+    ///< callers that already know which sockets are readable.  Returns
+    ///< -1 and sets status to BROKEN on failure.
+
+    vrpn_bool has_pending_reports(void) const
+    {
+        return has_pending_tcp_reports() || (d_udpNumOut > 0);
+    }
+    vrpn_bool has_pending_tcp_reports(void) const
+    {
+        return (d_tcpNumOut[vrpn_CONNECTION_PRIORITY_CONTROL] > 0) ||
+               (d_tcpNumOut[vrpn_CONNECTION_PRIORITY_REPORT] > 0) ||
+               (d_tcpNumOut[vrpn_CONNECTION_PRIORITY_BULK] > 0);
+    }
+
+    /// True if bulk messages are waiting for the TCP socket to have room;
+    /// the connection tries them again every millisecond or so.
+    vrpn_bool bulk_held(void) const
+    {
+        return d_tcpNumOut[vrpn_CONNECTION_PRIORITY_BULK] > 0;
+    }
+
+    /// True if a worker thread owns this endpoint's sending (see
+    /// vrpn_Connection::set_endpoint_shards()).  The connection must not
+    /// touch its outbound buffers or sockets while it is.
+    vrpn_bool sharded(void) const
+    {
+#ifdef vrpn_CONNECTION_USE_SHARDS
+        return d_shard != NULL;
+#else
+        return vrpn_FALSE;
+#endif
+    }
+
+    /// Marks the endpoint BROKEN.  A worker must not change status under
+    /// the connection, so for a sharded endpoint this only leaves a note
+    /// that the connection's thread acts on in check_shard_failure().
+    void mark_broken(void);
+    vrpn_bool shard_failed(void) const;
+    vrpn_bool check_shard_failure(void);
+    ///< Marks the endpoint BROKEN if its worker found it so, and
+    ///< returns whether it did.
+
+    /// True if handle_udp_messages() stopped at the get_Jane_value() cap
+    /// with datagrams from its last batch still to be handed out.  Those
+    /// are no longer in the socket, so callers must not wait for it to
+    /// become readable before calling again.
+    vrpn_bool has_pending_udp(void) const
+    {
+#ifdef vrpn_CONNECTION_USE_RECVMMSG
+        return d_udpBatchNext < d_udpBatchCount;
+#else
+        return vrpn_FALSE;
+#endif
+    }
+
+    vrpn_bool has_pending_tcp(void) const;
+    ///< True if handle_tcp_messages() stopped at the get_Jane_value() cap
+    ///< with whole messages still buffered.  As with has_pending_udp(),
+    ///< callers must not wait for the socket before calling again.
+
+    /// True once everything this endpoint sends goes through the peer's
+    /// shared-memory ring rather than its sockets.
+    vrpn_bool shm_outbound(void) const
+    {
+#ifdef vrpn_CONNECTION_USE_SHM
+        return d_shmOut != NULL;
+#else
+        return vrpn_FALSE;
+#endif
+    }
+
+    vrpn_bool has_pending_shm(vrpn_bool will_wait);
+    ///< True if the peer has written to our shared-memory ring and we
+    ///< have not read it yet.  Callers about to wait on the sockets pass
+    ///< will_wait, which has the peer wake us through the TCP socket the
+    ///< next time it writes.
+
+    int handle_shm_description(vrpn_bool writing, const char *name);
+    ///< Takes the peer's vrpn_CONNECTION_SHM_DESCRIPTION:  writing says
+    ///< that all it sends from now on comes through our ring, and name
+    ///< (if not empty) is a ring of its own for us to write to.
+
+    int pack_multicast_description(const char *group, int port);
+    ///< Offers the peer the connection's multicast group, or with a port
+    ///< of 0 tells the peer that we have joined the group it offered.
+    int handle_multicast_description(const char *group, int port);
+    ///< Takes the peer's vrpn_CONNECTION_MULTICAST_DESCRIPTION.  A client
+    ///< offered a group reads its UDP from the group from then on and
+    ///< says so;  a server told so stops sending it UDP of its own, and
+    ///< says that back once what it had sent is on its way.
+    int handle_unicast_udp_messages(void);
+    ///< Reads, without waiting, what is on d_udpUnicastSocket.  Returns
+    ///< the number of messages read, or -1 on error.
+
+    /// True once the other side reads the connection's multicast group, so
+    /// that its vrpn_CONNECTION_LOW_LATENCY messages go there instead;  see
+    /// vrpn_Connection::set_multicast_group().
+    vrpn_bool multicast_member(void) const { return d_multicastMember; }
+
+#ifdef vrpn_CONNECTION_USE_EPOLL
+    void reactor_update(int epollFD);
+    ///< Brings this endpoint's entries in the connection's epoll set in
+    ///< line with the sockets its current state waits on.  Makes no
+    ///< system calls unless the state or the sockets have changed.
+
+    vrpn_uint32 d_reactorReady; ///< Readiness bits from the last wait
+#endif
+
     /// @todo XXX These should be protected; making them so will lead to making
     ///    the code split the functions between Endpoint and Connection
     ///    protected:
@@ -462,6 +876,9 @@ public:
     char *d_remote_machine_name;    ///< Machine to call
     int d_remote_port_number;       ///< Port to connect to on remote machine
     timeval d_last_connect_attempt; ///< When the last UDP lob occurred
+    vrpn_int32 d_retryMsecs;        ///< Wait from then to the next one
+    vrpn_bool d_tcpConnecting;      ///< connect_tcp_to() still going
+    timeval d_connectDeadline;      ///< When to give up on it
 
     vrpn_bool d_tcp_only;
     ///< For connections made through firewalls or NAT with the
@@ -469,10 +886,46 @@ public:
     ///< end to open a UDP link to their counterparts.  If this is
     ///< the case, then this flag should be set to true.
 
+    vrpn_bool d_shm_offer;
+    ///< Offer the peer shared memory once connected.  Set for clients of
+    ///< shm: URLs and of localhost;  a peer on another host, or one
+    ///< built without shared memory, ignores the offer and the
+    ///< connection stays on TCP and UDP.
+
+    vrpn_bool d_multicastOffered; ///< We offered the peer our group
+    vrpn_bool d_multicastMember;  ///< and it has joined
+    SOCKET d_udpUnicastSocket;
+    ///< Our own inbound UDP socket, once d_udpInboundSocket reads the
+    ///< server's group.  It is read until the server says it has stopped
+    ///< sending there, so that reports it sent before it heard we joined
+    ///< are not lost, and then kept open so that any stragglers don't
+    ///< bounce.
+    vrpn_bool d_unicastPending; ///< d_udpUnicastSocket is still read
+
 protected:
     int getOneTCPMessage(int fd, char *buf, size_t buflen);
     int getOneUDPMessage(char *buf, size_t buflen);
 
+    int finish_tcp_connect(void);
+    ///< Puts a newly connected d_tcpSocket back into blocking mode, which
+    ///< the send code expects, sets TCP_NODELAY, and moves on to
+    ///< COOKIE_PENDING.  Returns -1 and closes the socket on failure.
+    void abandon_tcp_connect(void);
+    ///< Closes a d_tcpSocket whose connect failed or ran out of time.
+
+    char d_cookieIn[32]; ///< The peer's cookie, as much as has arrived
+    int d_cookieRead;    ///< Bytes of it in d_cookieIn
+#ifdef vrpn_CONNECTION_USE_TCP_STREAM
+    int read_tcp_stream(vrpn_bool *drained);
+    ///< Appends what the TCP socket holds to d_tcpStreamInbuf without
+    ///< blocking.  Returns the bytes read, or -1 if the connection failed
+    ///< or closed.  Sets drained if the socket had no more.
+    int dispatch_tcp_stream(unsigned *num_messages_read);
+    ///< Hands out the complete messages in d_tcpStreamInbuf.  Returns 1
+    ///< if it stopped at the get_Jane_value() cap, 0 if it ran out of
+    ///< whole messages, or -1 on failure.
+#endif
+
     SOCKET d_udpOutboundSocket;
     SOCKET d_udpInboundSocket;
     ///< Inbound unreliable messages come here.
@@ -481,26 +934,113 @@ protected:
     ///< need to know which server each message is from.
     ///< @todo XXX Now that we don't need multiple clocks, can we collapse this?
 
-    char *d_tcpOutbuf;
+    /// One TCP buffer per priority class, each d_tcpBuflen long.  Only
+    /// the REPORT buffer is made up front;  the others when first used.
+    char *d_tcpOutbuf[vrpn_CONNECTION_PRIORITIES];
     char *d_udpOutbuf;
     vrpn_int32 d_tcpBuflen;
     vrpn_int32 d_udpBuflen;
-    vrpn_int32 d_tcpNumOut;
+    vrpn_int32 d_tcpNumOut[vrpn_CONNECTION_PRIORITIES];
     vrpn_int32 d_udpNumOut;
 
+    /// Bytes at the start of the bulk buffer that finish a message whose
+    /// beginning the socket has already taken;  they must go next.
+    vrpn_int32 d_tcpBulkSplit;
+    SOCKET d_tcpUnsentLimitSocket; ///< Socket TCP_NOTSENT_LOWAT was set on
+    vrpn_TCPQueueStats d_tcpStats[vrpn_CONNECTION_PRIORITIES];
+
+    int make_tcp_room(int priority);
+    ///< Makes the buffer for priority if need be, or sends what is
+    ///< queued to make room in it.  Returns -1 on failure.
+    int send_tcp(int priority, vrpn_int32 count, vrpn_bool wait);
+    ///< Sends the first count bytes of the buffer for priority and moves
+    ///< the rest up.  Unless wait, stops when the socket would block.
+    ///< Returns the number sent, or -1 on failure.
+    void note_tcp_packed(int priority, vrpn_int32 bytes);
+
     vrpn_int32 d_tcpSequenceNumber;
     vrpn_int32 d_udpSequenceNumber;
 
+    vrpn_int32 d_udpNumMsgs;   ///< Messages in d_udpOutbuf
+    timeval d_udpQueuedSince; ///< When the first of them was packed
+    vrpn_UDPStats d_udpStats;
+
+    void note_udp_packed(void);
+
     vrpn_float64
         d_tcpAlignedInbuf[vrpn_CONNECTION_TCP_BUFLEN / sizeof(vrpn_float64) +
                           1];
-    vrpn_float64
-        d_udpAlignedInbuf[vrpn_CONNECTION_UDP_BUFLEN / sizeof(vrpn_float64) +
-                          1];
+    vrpn_float64 d_udpAlignedInbuf[vrpn_CONNECTION_UDP_MAX_BUFLEN /
+                                       sizeof(vrpn_float64) +
+                                   1];
     char *d_tcpInbuf;
     char *d_udpInbuf;
 
+#ifdef vrpn_CONNECTION_USE_RECVMMSG
+    /// vrpn_CONNECTION_UDP_BATCH datagram buffers, each the size and
+    /// alignment of d_udpAlignedInbuf.  Allocated on first use.
+    vrpn_float64 *d_udpBatchInbuf;
+    vrpn_int32 d_udpBatchLength[vrpn_CONNECTION_UDP_BATCH];
+    timeval d_udpBatchArrival[vrpn_CONNECTION_UDP_BATCH];
+    int d_udpBatchCount; ///< Datagrams in the batch
+    int d_udpBatchNext;  ///< First one not yet handed to getOneUDPMessage()
+#endif
+
+#ifdef vrpn_CONNECTION_USE_TCP_STREAM
+    /// vrpn_CONNECTION_TCP_STREAM_BUFLEN bytes of incoming TCP stream,
+    /// aligned like d_tcpAlignedInbuf.  Allocated on first use.
+    vrpn_float64 *d_tcpStreamInbuf;
+    size_t d_tcpStreamStart; ///< First byte not yet handed out
+    size_t d_tcpStreamEnd;   ///< End of what has been received
+    size_t d_tcpStreamFresh; ///< Where the last recv() started putting bytes
+    timeval d_tcpStreamArrival[2];
+    ///< When the bytes before d_tcpStreamFresh, and those after it,
+    ///< arrived (zero unless arrival timestamps are on).
+#endif
+
     char *d_NICaddress;
+
+#ifdef vrpn_CONNECTION_USE_RX_TIMESTAMPS
+    SOCKET d_rxStampSockets[2]; ///< Sockets SO_TIMESTAMPNS was set on
+    vrpn_bool d_rxStamping;     ///< What it was set to
+#endif
+
+#ifdef vrpn_CONNECTION_USE_EPOLL
+    SOCKET d_reactorSockets[2]; ///< Sockets in the epoll set (TCP, UDP)
+    int d_reactorStatus;        ///< status when they were registered
+#endif
+
+#ifdef vrpn_CONNECTION_USE_SENDMMSG
+    /// Where d_udpOutboundSocket is connected to (network byte order;
+    /// port 0 if not connected), so the connection can send our UDP
+    /// buffer from its fan-out socket.
+    vrpn_uint32 d_udpPeerAddr;
+    vrpn_uint16 d_udpPeerPort;
+
+    friend class vrpn_Connection_IP;
+#endif
+
+#ifdef vrpn_CONNECTION_USE_SHM
+    int pack_shm_description(vrpn_bool writing, const char *name);
+    int handle_shm_messages(void);
+    int send_shm(const char *buffer, vrpn_int32 length);
+    void close_shm(void);
+
+    vrpn_ShmRing *d_shmIn;  ///< Ring we created for the peer to write to
+    vrpn_ShmRing *d_shmOut; ///< Ring of the peer's that we write to
+    unsigned long long d_shmInTail;  ///< Our own copies of the positions
+    unsigned long long d_shmOutHead; ///< we move, which the peer can't touch
+    vrpn_bool d_shmInUse;   ///< The peer has switched to writing d_shmIn
+    char d_shmInName[64];   ///< Until the peer has opened d_shmIn
+#endif
+
+#ifdef vrpn_CONNECTION_USE_SHARDS
+    vrpn_EndpointShard *d_shard; ///< Worker that sends for us, or NULL
+    size_t d_shardStart; ///< First queued message that is ours to send
+    int d_shardFailed;   ///< Set by the worker when a send fails
+
+    friend class vrpn_EndpointShards;
+#endif
 };
 
 /// @brief Generic connection class not specific to the transport mechanism.
@@ -580,6 +1120,17 @@ public:
                              vrpn_int32 type, vrpn_int32 sender,
                              const char *buffer, vrpn_uint32 class_of_service);
 
+    /// Like pack_message(), but only to the endpoints whose other side has
+    /// (if accepted is true) or has not (if false) called
+    /// accept_alternate_type() for accepted_type from this sender;  local
+    /// handlers get it if this end has or has not.  Lets a device send a
+    /// message to clients that read it and something equivalent to the
+    /// others.  An accepted_type of -1 packs it for everyone.
+    int pack_message_if(vrpn_int32 accepted_type, vrpn_bool accepted,
+                        vrpn_uint32 len, struct timeval time, vrpn_int32 type,
+                        vrpn_int32 sender, const char *buffer,
+                        vrpn_uint32 class_of_service);
+
     /// send pending report, clear the buffer.
     /// This function was protected, now is public, so we can use it
     /// to send out intermediate results without calling mainloop
@@ -644,12 +1195,242 @@ public:
         return d_stop_processing_messages_after;
     };
 
+    /// @name Batching of vrpn_CONNECTION_LOW_LATENCY (UDP) messages
+    ///
+    /// Messages are packed into a datagram until it is full, and the
+    /// flush policy says when a partly full one goes out:
+    /// vrpn_CONNECTION_UDP_FLUSH_MAINLOOP (the default) sends it once per
+    /// mainloop();  vrpn_CONNECTION_UDP_FLUSH_IMMEDIATE sends each message
+    /// as it is packed, for the lowest latency, along with any reliable
+    /// messages packed before it (so that a new type's description never
+    /// arrives after the first datagram that uses the type);
+    /// vrpn_CONNECTION_UDP_FLUSH_COALESCE holds it until it is full or its
+    /// first message has waited max_delay_usec, for the fewest datagrams.
+    /// send_pending_reports() always sends everything.
+    ///
+    /// The payload size is vrpn_CONNECTION_UDP_BUFLEN by default and can be
+    /// set anywhere from vrpn_CONNECTION_UDP_MIN_BUFLEN to
+    /// vrpn_CONNECTION_UDP_MAX_BUFLEN, for jumbo frames on a network that
+    /// carries them everywhere.  Both setters return -1 if the value is
+    /// out of range.
+    ///
+    /// get_udp_stats() reports what endpoint number which has sent, so
+    /// that messages per datagram can be watched;  it returns -1 once
+    /// which is past the last endpoint.
+    /// @{
+    int set_udp_payload_size(vrpn_int32 bytes);
+    vrpn_int32 get_udp_payload_size(void) const { return d_udpPayloadSize; }
+    int set_udp_flush_policy(int policy, vrpn_uint32 max_delay_usec = 0);
+    int get_udp_flush_policy(void) const { return d_udpFlushPolicy; }
+    vrpn_uint32 get_udp_flush_delay(void) const { return d_udpFlushDelay; }
+    int get_udp_stats(vrpn_int32 which, vrpn_UDPStats *stats) const;
+    /// @}
+
+    /// Asks the kernel to timestamp each incoming TCP and UDP message as
+    /// it arrives, and passes the stamp to handlers as
+    /// vrpn_HANDLERPARAM::arrival_time (and on to device callbacks such
+    /// as vrpn_TRACKERCB::arrival_time).  Comparing it with msg_time
+    /// gives network latency and jitter free of the receiving program's
+    /// own scheduling delays.  Off by default; returns -1 if this build
+    /// can't do it (VRPN_USE_RX_TIMESTAMPS, Linux only).
+    int set_arrival_timestamps(vrpn_bool on);
+    vrpn_bool get_arrival_timestamps(void) const
+    {
+        return d_arrivalTimestamps;
+    }
+
+    /// @name Priority of reliable messages
+    /// Reliable messages of each vrpn_CONNECTION_PRIORITY_ class are
+    /// buffered apart, and whenever messages are sent the CONTROL ones go
+    /// first and then the REPORTs.  BULK ones only go while the socket
+    /// has room, so a large image or file never holds up the reports
+    /// behind it for long.  Order is kept within a class but not between
+    /// them, so all messages that must stay in order should share one.
+    /// System messages are CONTROL and other types REPORT unless
+    /// set_type_priority() says otherwise;  it returns -1 for a type that
+    /// has not been registered, and get_type_priority() gives REPORT for
+    /// one.  get_tcp_queue_stats() reports what each class of endpoint
+    /// number which has sent and how often it had to wait for room;  it
+    /// returns -1 once which is past the last endpoint.
+    /// @{
+    int set_type_priority(vrpn_int32 type, int priority);
+    int get_type_priority(vrpn_int32 type) const;
+    int get_tcp_queue_stats(vrpn_int32 which, int priority,
+                            vrpn_TCPQueueStats *stats) const;
+    /// @}
+
+    /// Hands the sending to connected clients to count worker threads,
+    /// each with its own share of the endpoints and its own epoll loop.
+    /// Every message is marshalled once onto a lock-free queue that all
+    /// of the workers read, and each copies it to its own endpoints and
+    /// sends; so a server with hundreds of clients spreads that work over
+    /// several cores.  mainloop() still accepts clients, reads what they
+    /// send and calls all handlers on the calling thread, so nothing else
+    /// about how devices use the connection changes.  send_pending_reports()
+    /// hands what is packed to the workers without waiting for them.
+    ///
+    /// A count of 0 (the default) sends from the calling thread; a
+    /// negative count uses one worker per processor.  Returns -1 if the
+    /// workers can't be started or this build can't do it
+    /// (VRPN_USE_ENDPOINT_SHARDS, Linux only).
+    virtual int set_endpoint_shards(int count);
+    int get_endpoint_shards(void) const;
+
+    /// Sends vrpn_CONNECTION_LOW_LATENCY messages once to a multicast
+    /// group (a dotted address such as "239.255.42.99") at port, rather
+    /// than once to each client's own UDP port;  so the work of sending
+    /// them and the bandwidth they take on the LAN no longer grow with
+    /// the number of clients.  Each client is offered the group over TCP
+    /// as it connects.  Those that join (any from this version that are
+    /// not tcp: clients) get all of their low-latency messages through
+    /// it, while older ones keep their own UDP port.  Sender and type
+    /// descriptions and all reliable messages still go over each
+    /// client's TCP connection.  The group is sent a message only in the
+    /// form that every member would be:  an alternate type (see
+    /// set_alternate_type()) goes there only if all of them accept it.
+    /// Clients can't tell one server's datagrams from another's, so give
+    /// each server its own group or port.  ttl is how many routers the
+    /// datagrams may cross;  1 keeps them on the local network.  The
+    /// group can be set only once.  Returns -1 if it is already set or
+    /// can't be opened, or this connection can't multicast.
+    virtual int set_multicast_group(const char *group, int port,
+                                    int ttl = 1);
+
+    /// What has been sent to the multicast group.  Returns -1 if there
+    /// is none.
+    int get_multicast_stats(vrpn_UDPStats *stats) const;
+
+    /// Used by the endpoints:  offer_multicast() offers the group to a
+    /// newly connected one, and update_multicast() works out again what
+    /// the group is sent once its members, or what they accept, change.
+    /// @{
+    int offer_multicast(vrpn_Endpoint_IP *endpoint);
+    void update_multicast(void);
+    /// @}
+
+    /// Lets a device offer a second encoding of one of its messages without
+    /// breaking older clients.  The device packs its messages of type
+    /// original and also of type alternate;  each endpoint whose other
+    /// side has called accept_alternate_type() for them is sent only the
+    /// alternate, and every other endpoint only the original.  Local
+    /// handlers only see the original.  It applies to messages from sender
+    /// only; passing an alternate of -1 undoes it.  Returns -1 on bad IDs
+    /// or if vrpn_CONNECTION_MAX_ALTERNATES pairs are already in use.
+    int set_alternate_type(vrpn_int32 sender, vrpn_int32 original,
+                           vrpn_int32 alternate);
+
+    /// Tells the other side, now and on each reconnection, that this end
+    /// reads messages of type alternate from sender in place of the usual
+    /// ones (a vrpn_CONNECTION_ALTERNATE_DESCRIPTION, which older servers
+    /// ignore).  Merely registering the type is not enough, since every
+    /// connection registers each type its peer describes.  Returns -1 for
+    /// an unknown sender or type, or if out of memory.
+    int accept_alternate_type(vrpn_int32 sender, vrpn_int32 alternate);
+
+    /// Used by the endpoints:  update_alternates() works out which
+    /// alternate types an endpoint's other side accepts, sends_to() says
+    /// whether a message goes to it, and pack_alternate_descriptions()
+    /// repeats what this end accepts to a newly connected one.
+    /// @{
+    void update_alternates(vrpn_Endpoint *endpoint) const;
+    int pack_alternate_descriptions(vrpn_Endpoint *endpoint);
+    vrpn_bool sends_to(const vrpn_Endpoint *endpoint, vrpn_int32 type,
+                       vrpn_int32 sender) const
+    {
+        return !d_numAlternates || (type < 0) ||
+               alternate_sends_to(endpoint->d_peerAlternates, type, sender);
+    }
+    /// @}
+
+    /// Asks for only the newest of the messages of type from sender
+    /// (vrpn_ANY_SENDER for all) that arrive together.  Each time an
+    /// endpoint reads what is waiting on its sockets, it holds these back
+    /// and calls their handlers once the read is done, for the newest
+    /// message of each stream only;  so a program that has fallen behind
+    /// handles one report per stream per mainloop() rather than working
+    /// through a backlog of old ones.  The messages held back are handled
+    /// after the others read with them.  If key_offset is not -1, the
+    /// vrpn_int32 at that byte offset into each message (a tracker's
+    /// sensor number, for example) splits the messages into separate
+    /// streams;  messages too short to have one are never held back.
+    /// If epoch_offset is not -1, the vrpn_int32 there (a frame number,
+    /// say) counts up, and streams of one sender and type are only
+    /// handled together from the newest epoch read:  a message from an
+    /// older one is dropped rather than handled with parts of a newer one.
+    /// Passing on = vrpn_FALSE undoes it.  Returns -1 on bad IDs or if
+    /// vrpn_CONNECTION_MAX_LATEST_ONLY pairs are already in use.
+    int set_latest_only(vrpn_int32 sender, vrpn_int32 type, vrpn_bool on,
+                        vrpn_int32 key_offset = -1,
+                        vrpn_int32 epoch_offset = -1);
+
+    /// Number of latest-only messages that have been skipped in favour of
+    /// a newer one, over all endpoints.
+    vrpn_uint32 get_latest_dropped(void) const;
+
+    /// Used by the endpoints:  says whether a message is latest-only, and
+    /// if so which stream it belongs to and, if it has one, its epoch.
+    vrpn_bool latest_only(vrpn_int32 sender, vrpn_int32 type,
+                          vrpn_uint32 len, const char *buffer,
+                          vrpn_int32 *key, vrpn_bool *has_epoch,
+                          vrpn_int32 *epoch) const;
+
 protected:
     /// If this value is greater than zero, the connection should stop
     /// looking for new messages on a given endpoint after this many
     /// are found.
     vrpn_uint32 d_stop_processing_messages_after;
 
+    vrpn_int32 d_udpPayloadSize;
+    int d_udpFlushPolicy;
+    vrpn_uint32 d_udpFlushDelay; ///< Microseconds, for _COALESCE
+
+    vrpn_bool d_arrivalTimestamps;
+
+    /// Pairs set by set_alternate_type().  Slots are never moved or
+    /// reused for another pair, so worker threads can read them while the
+    /// connection's thread adds more.
+    struct vrpn_AlternateType {
+        vrpn_int32 sender;
+        vrpn_int32 original;
+        vrpn_int32 alternate; ///< -1 when undone
+    };
+    vrpn_AlternateType d_alternates[vrpn_CONNECTION_MAX_ALTERNATES];
+    int d_numAlternates;
+
+    /// Pairs passed to accept_alternate_type(), allocated on the first.
+    vrpn_SenderType *d_accepts;
+    int d_numAccepts;
+    int d_maxAccepts;
+
+    /// Pairs set by set_latest_only().
+    struct vrpn_LatestOnlyType {
+        vrpn_int32 sender; ///< vrpn_ANY_SENDER for all
+        vrpn_int32 type;
+        vrpn_int32 key_offset;
+        vrpn_int32 epoch_offset;
+    };
+    vrpn_LatestOnlyType d_latestOnly[vrpn_CONNECTION_MAX_LATEST_ONLY];
+    int d_numLatestOnly;
+
+    vrpn_bool alternate_sends_to(vrpn_uint32 declared, vrpn_int32 type,
+                                 vrpn_int32 sender) const;
+    ///< Whether a message goes to a side that accepts the alternate types
+    ///< whose bits are set in declared.
+    vrpn_bool packs_for(const vrpn_Endpoint *endpoint,
+                        vrpn_int32 accepted_type, vrpn_bool accepted,
+                        vrpn_int32 sender) const;
+    vrpn_bool packs_for_multicast(vrpn_int32 type, vrpn_int32 sender,
+                                  vrpn_int32 accepted_type,
+                                  vrpn_bool accepted) const;
+    ///< Whether pack_message_if() sends a low-latency message to the
+    ///< multicast group:  whether it has members and they take it.
+
+    vrpn_MulticastGroup *d_multicast; ///< Set by set_multicast_group()
+
+#ifdef vrpn_CONNECTION_USE_SHARDS
+    vrpn_EndpointShards *d_shards; ///< Worker threads, or NULL if none
+#endif
+
     int connectionStatus; ///< Status of the connection
 
     static vrpn_Endpoint_IP *allocateEndpoint(vrpn_Connection *,
@@ -697,6 +1478,15 @@ protected:
     /// Returns message type ID, or -1 if unregistered
     int message_type_is_registered(const char *) const;
 
+    virtual void flush_endpoints(vrpn_bool hold_udp);
+    ///< Sends whatever each endpoint has packed.  If hold_udp is set,
+    ///< UDP buffers that are still coalescing are left to fill.
+
+    /// pack_message() marshals each message here once and lets every
+    /// endpoint copy it, rather than marshalling it for each endpoint.
+    char *d_marshalBuf;
+    vrpn_uint32 d_marshalBuflen;
+
     /// Timekeeping - TCH 30 June 98
     timeval start_time;
 
@@ -811,6 +1601,10 @@ public:
     /// Optional argument is TOTAL time to block on select() calls;
     /// there may be multiple calls to select() per call to mainloop(),
     /// and this timeout will be divided evenly between them.
+    /// With VRPN_USE_EPOLL on Linux there is instead a single
+    /// epoll_wait() across the listen sockets and every endpoint, so the
+    /// cost of a pass grows with the number of active sockets rather
+    /// than the number of connected clients.
     virtual int mainloop(const struct timeval *timeout = NULL);
 
 protected:
@@ -839,6 +1633,10 @@ protected:
     /// Routines that handle system messages
     static int VRPN_CALLBACK
     handle_UDP_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_shm_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_multicast_message(void *userdata, vrpn_HANDLERPARAM p);
 
     /// @brief Called by all constructors
     virtual void init(void);
@@ -862,7 +1660,44 @@ protected:
 
     virtual void drop_connection(int whichEndpoint);
 
+    /// Sends whatever each endpoint has packed.  With VRPN_USE_SENDMMSG
+    /// on Linux, the UDP buffers of all endpoints go out together in one
+    /// sendmmsg() on d_udpFanoutSocket.  Sharded endpoints are left to
+    /// their workers.
+    virtual void flush_endpoints(vrpn_bool hold_udp);
+
+    static void send_endpoints(vrpn_Endpoint_IP **endpoints, int count,
+                               vrpn_bool hold_udp, SOCKET *fanoutSocket,
+                               const char *NIC_IP);
+    ///< The work of flush_endpoints() for any set of endpoints, so that
+    ///< the shard workers can do it for theirs.  *fanoutSocket is opened
+    ///< on first use.
+
+    virtual int set_endpoint_shards(int count);
+    virtual int set_multicast_group(const char *group, int port,
+                                    int ttl = 1);
+
+#ifdef vrpn_CONNECTION_USE_SHARDS
+    void shard_connected_endpoints(void);
+    ///< Hands endpoints that have finished connecting to the workers.
+
+    friend class vrpn_EndpointShards;
+#endif
+
+    void limit_to_held_reports(timeval *timeout) const;
+    ///< Shortens timeout so a wait ends when the first held UDP buffer
+    ///< is due, or soon if bulk messages are waiting for the socket.
+
     char *d_NIC_IP;
+
+#ifdef vrpn_CONNECTION_USE_SENDMMSG
+    SOCKET d_udpFanoutSocket; ///< Unconnected; opened on first use
+#endif
+
+#ifdef vrpn_CONNECTION_USE_EPOLL
+    int d_epollFD; ///< Wait set for the listen sockets and all endpoints
+    int mainloop_epoll(const struct timeval *timeout);
+#endif
 };
 
 /// @brief Constructor for a Loopback connection that will basically just
@@ -919,6 +1754,14 @@ protected:
 /// made even if there was already one to that server.
 /// When done with the object, call removeReference() on it (which will
 /// delete it if there are no other references).
+///
+/// Multiplexing:  every name that vrpn_ConnectionManager::normalizeName()
+/// maps to the same host, port and transport gets the same connection,
+/// whatever device is named before the '@'.  So any number of
+/// vrpn_Tracker_Remote (or other) objects for devices on one server share
+/// its single TCP socket and UDP socket, with the devices told apart by
+/// their sender names, and finding the connection for each new object
+/// takes constant time.
 VRPN_API vrpn_Connection *vrpn_get_connection_by_name(
     const char *cname, const char *local_in_logfile_name = NULL,
     const char *local_out_logfile_name = NULL,
@@ -995,6 +1838,8 @@ VRPN_API char *vrpn_copy_file_name(const char *filespecifier);
 ///
 ///   x-vrpn://<hostname>:<port number>
 ///
+///   shm://<hostname>:<port number>
+///
 ///   x-vrsh://<hostname>/<server program>,<comma-separated server arguments>
 ///
 /// The caller is responsible for calling delete [] on the returned character
@@ -1071,36 +1916,56 @@ public:
     /// the program terminates.
     static vrpn_ConnectionManager &instance(void);
 
-    /// NB implementation is not particularly efficient;  we expect
-    /// to have O(10) connections, not O(1000).
+    /// Named connections are indexed by the normalized form of their
+    /// name (see normalizeName()), so finding one takes constant time
+    /// however many are open.  Deleting one walks the list.
     /// @{
     void addConnection(vrpn_Connection *, const char *name);
     void deleteConnection(vrpn_Connection *);
     /// @}
 
-    /// Searches through d_kcList but NOT d_anonList
-    /// (Connections constructed with no name)
+    /// Searches the named connections but NOT d_anonList
+    /// (Connections constructed with no name).  If more than one has
+    /// the same normalized name, returns the newest.
     vrpn_Connection *getByName(const char *name);
 
+    /// Writes the form of a connection name that getByName() compares:
+    /// "x-vrpn://", "tcp://" or "shm://", the host in lower case, ':' and
+    /// the port, with the default port filled in.  So "Motive",
+    /// "motive:3883" and "x-vrpn://MOTIVE" all come out the same, while
+    /// "tcp://motive" (a different transport) does not.  Other names
+    /// (files, x-vrsh:, loopback) are copied unchanged.  Does not look
+    /// anything up, so a host's name and its IP address differ.
+    static void normalizeName(const char *name, char *key, size_t keylen);
+
 private:
     struct knownConnection {
-        char name[1000];
+        char name[1000]; ///< Normalized
         vrpn_Connection *connection;
         knownConnection *next;
+        knownConnection *hashNext; ///< Next in the same bucket
     };
 
-    /// @brief named connections
+    /// @brief named connections, newest first
     knownConnection *d_kcList;
 
     /// @brief unnamed (server) connections
     knownConnection *d_anonList;
 
+    /// @brief named connections by hash of their name;  a power of two
+    /// number of buckets, doubled whenever there are more connections
+    knownConnection **d_buckets;
+    unsigned d_numBuckets;
+    unsigned d_numNamed;
+
     vrpn_ConnectionManager(void);
 
     // @brief copy constructor undefined to prevent instantiations
     vrpn_ConnectionManager(const vrpn_ConnectionManager &);
 
-    static void deleteConnection(vrpn_Connection *, knownConnection **);
+    static knownConnection *unlink(vrpn_Connection *, knownConnection **);
+    static unsigned hashName(const char *name);
+    bool rehash(unsigned numBuckets);
 };
 
 #endif // VRPN_CONNECTION_H
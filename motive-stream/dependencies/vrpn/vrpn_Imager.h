@@ -520,12 +520,6 @@ public:
                                 "Transcoding not implemented yet\n");
                 return false;
             }
-            else if (vrpn_big_endian) {
-                fprintf(stderr, "XXX "
-                                "vrpn_Imager_Region::read_unscaled_pixel(): "
-                                "Not implemented on big-endian yet\n");
-                return false;
-            }
             else {
                 // The data is packed in with column varying fastest, row
                 // varying next, and depth
@@ -562,12 +556,6 @@ public:
                                 "Transcoding not implemented yet\n");
                 return false;
             }
-            else if (vrpn_big_endian) {
-                fprintf(stderr, "XXX "
-                                "vrpn_Imager_Region::read_unscaled_pixel(): "
-                                "Not implemented on big-endian yet\n");
-                return false;
-            }
             else {
                 // The data is packed in with column varying fastest, row
                 // varying next, and depth
@@ -0,0 +1,180 @@
+/** @file
+    @brief Templates that pack and unpack fixed-layout VRPN messages from a
+    declared schema, in place of hand-written vrpn_buffer()/vrpn_unbuffer()
+    sequences.
+
+    A message is described twice, once as a plain struct laid out exactly as
+    it goes on the wire and once as a schema: a list of runs of same-typed
+    fields.  For example, a tracker pose (two vrpn_int32 then seven
+    vrpn_float64) is
+
+        struct vrpn_TRACKERPOSMSG {
+            vrpn_int32 sensor;
+            vrpn_int32 padding;
+            vrpn_float64 pos[3];
+            vrpn_float64 quat[4];
+        };
+        typedef vrpn_Schema<vrpn_SchemaField<vrpn_int32, 2>,
+                vrpn_Schema<vrpn_SchemaField<vrpn_float64, 7> > >
+            vrpn_TRACKERPOSSCHEMA;
+
+    and is then sent with
+
+        vrpn_buffer_message<vrpn_TRACKERPOSSCHEMA>(&bufptr, &buflen, msg);
+
+    and received with
+
+        if (p.payload_len != vrpn_TRACKERPOSSCHEMA::size) { ...error... }
+        vrpn_unbuffer_message<vrpn_TRACKERPOSSCHEMA>(&bufptr, &msg);
+
+    The wire format is the one vrpn_buffer() produces field by field, so
+    these interoperate with peers that still use it.  Each run is converted
+    by one call to vrpn_swap_array_bytes() rather than by a call per field.
+
+    The last run of a schema may be a vrpn_SchemaTail, an array whose length
+    is only known at run time (such as the channels of an analog report).
+    Its count is passed to vrpn_buffer_message() and vrpn_unbuffer_message().
+*/
+
+#ifndef VRPN_MESSAGE_SCHEMA_H
+#define VRPN_MESSAGE_SCHEMA_H
+
+#include <stddef.h> // for NULL, size_t
+#include <stdio.h>  // for fprintf, stderr
+#include <string.h> // for memcpy
+
+#include "vrpn_Shared.h" // for vrpn_swap_array_bytes, VRPN_STATIC_ASSERT, etc
+#include "vrpn_Types.h"  // for vrpn_int32, vrpn_uint32, etc
+
+/// @brief A run of Count fields of type T, in the order they go on the wire.
+template <typename T, int Count = 1> struct vrpn_SchemaField {
+    typedef T type;
+    enum { count = Count, size = Count * sizeof(T), tail = 0 };
+};
+
+/// @brief A run of up to MaxCount fields of type T that ends a message.
+/// How many are present is given when the message is packed or unpacked.
+template <typename T, int MaxCount> struct vrpn_SchemaTail {
+    typedef T type;
+    enum { count = MaxCount, size = MaxCount * sizeof(T), tail = 1 };
+};
+
+/// @brief Marks the end of a schema.
+struct vrpn_SchemaEnd {
+    enum { size = 0, fixed_size = 0 };
+};
+
+/// @brief A message made of the run First followed by the schema Rest.
+/// size is the most bytes the message can take;  fixed_size leaves out a
+/// vrpn_SchemaTail, and is the whole size for messages without one.
+template <typename First, typename Rest = vrpn_SchemaEnd> struct vrpn_Schema {
+    typedef First first;
+    typedef Rest rest;
+    enum {
+        size = First::size + Rest::size,
+        fixed_size = (First::tail ? 0 : First::size) + Rest::fixed_size
+    };
+
+    /// Bytes on the wire for a message whose tail holds tail_count fields.
+    static vrpn_int32 size_with_tail(int tail_count)
+    {
+        return fixed_size + tail_bytes(tail_count);
+    }
+
+    static vrpn_int32 tail_bytes(int tail_count)
+    {
+        return First::tail
+                   ? static_cast<vrpn_int32>(tail_count * sizeof(typename First::type))
+                   : Rest_tail_bytes(tail_count, static_cast<Rest *>(NULL));
+    }
+
+private:
+    template <typename R>
+    static vrpn_int32 Rest_tail_bytes(int tail_count, R *)
+    {
+        return R::tail_bytes(tail_count);
+    }
+    static vrpn_int32 Rest_tail_bytes(int, vrpn_SchemaEnd *) { return 0; }
+};
+
+namespace vrpn_detail {
+    /// Converts count values of Size bytes each between host and network
+    /// byte order.  The conversion is its own inverse, so it serves for
+    /// packing and unpacking alike.
+    template <int Size> struct schema_run {
+        static void convert(char *to, const char *from, int count)
+        {
+            if (vrpn_big_endian || (Size == 1)) {
+                memcpy(to, from, count * Size);
+            }
+            else {
+                vrpn_swap_array_bytes(to, from, count, Size);
+            }
+        }
+    };
+
+    /// Walks a schema run by run.  Host and wire layouts are the same, so
+    /// each run starts at the same offset in both.
+    template <typename Schema> struct schema_codec {
+        typedef typename Schema::first first;
+        typedef typename first::type type;
+
+        static void convert(char *to, const char *from, int tail_count)
+        {
+            schema_run<sizeof(type)>::convert(
+                to, from, first::tail ? tail_count : int(first::count));
+            schema_codec<typename Schema::rest>::convert(
+                to + first::size, from + first::size, tail_count);
+        }
+    };
+
+    template <> struct schema_codec<vrpn_SchemaEnd> {
+        static void convert(char *, const char *, int) {}
+    };
+} // end of namespace vrpn_detail
+
+/// @brief Packs msg, laid out as Schema says, into the buffer in network
+/// byte order.  Advances *insertPt and decrements *buflen like
+/// vrpn_buffer().  tail_count is how many fields of a vrpn_SchemaTail to
+/// send.  Returns 0 on success, -1 if the buffer is too small.
+template <typename Schema, typename Msg>
+inline int vrpn_buffer_message(char **insertPt, vrpn_int32 *buflen,
+                               const Msg &msg, int tail_count = 0)
+{
+    VRPN_STATIC_ASSERT(sizeof(Msg) == static_cast<size_t>(Schema::size),
+                       MESSAGE_STRUCT_DOES_NOT_MATCH_SCHEMA);
+
+    vrpn_int32 len = Schema::size_with_tail(tail_count);
+    if ((insertPt == NULL) || (buflen == NULL)) {
+        fprintf(stderr, "vrpn_buffer_message: NULL pointer\n");
+        return -1;
+    }
+    if (len > *buflen) {
+        fprintf(stderr, "vrpn_buffer_message: buffer not large enough\n");
+        return -1;
+    }
+    vrpn_detail::schema_codec<Schema>::convert(
+        *insertPt, reinterpret_cast<const char *>(&msg), tail_count);
+    *insertPt += len;
+    *buflen -= len;
+    return 0;
+}
+
+/// @brief Unpacks a message laid out as Schema says from the buffer into
+/// msg, advancing *buffer past it.  The caller checks the payload length
+/// against Schema::size (or size_with_tail()) first, as the hand-written
+/// handlers do.  Returns 0.
+template <typename Schema, typename Msg>
+inline int vrpn_unbuffer_message(const char **buffer, Msg *msg,
+                                 int tail_count = 0)
+{
+    VRPN_STATIC_ASSERT(sizeof(Msg) == static_cast<size_t>(Schema::size),
+                       MESSAGE_STRUCT_DOES_NOT_MATCH_SCHEMA);
+
+    vrpn_detail::schema_codec<Schema>::convert(reinterpret_cast<char *>(msg),
+                                               *buffer, tail_count);
+    *buffer += Schema::size_with_tail(tail_count);
+    return 0;
+}
+
+#endif // VRPN_MESSAGE_SCHEMA_H
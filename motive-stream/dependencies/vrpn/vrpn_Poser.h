@@ -8,13 +8,29 @@
 //       will come later, as needed.
 
 #include "vrpn_BaseClass.h" // for vrpn_Callback_List, etc
-#include "vrpn_Configure.h" // for VRPN_CALLBACK, VRPN_API
-#include "vrpn_Shared.h"    // for timeval
-#include "vrpn_Types.h"     // for vrpn_float64, vrpn_int32
+#include "vrpn_Configure.h"     // for VRPN_CALLBACK, VRPN_API
+#include "vrpn_MessageSchema.h" // for vrpn_Schema, vrpn_SchemaField
+#include "vrpn_Shared.h"        // for timeval
+#include "vrpn_Types.h"         // for vrpn_float64, vrpn_int32
 
 class VRPN_API vrpn_Connection;
 struct vrpn_HANDLERPARAM;
 
+// Wire layouts of the pose and velocity requests (absolute or relative),
+// packed and unpacked with vrpn_buffer_message()/vrpn_unbuffer_message().
+struct vrpn_POSERPOSMSG {
+    vrpn_float64 pos[3];
+    vrpn_float64 quat[4];
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_float64, 7> > vrpn_POSERPOSSCHEMA;
+
+struct vrpn_POSERVELMSG {
+    vrpn_float64 vel[3];
+    vrpn_float64 vel_quat[4];
+    vrpn_float64 vel_quat_dt;
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_float64, 8> > vrpn_POSERVELSCHEMA;
+
 class VRPN_API vrpn_Poser : public vrpn_BaseClass {
 public:
     vrpn_Poser(const char* name, vrpn_Connection* c = NULL);
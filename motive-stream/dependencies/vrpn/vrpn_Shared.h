@@ -326,7 +326,10 @@ namespace vrpn_detail {
     /// @brief Each static assertion needs its message in this enum, or it will
     /// always fail.
     template <> struct vrpn_static_assert<true> {
-        enum { SIZE_OF_BUFFER_ITEM_IS_NOT_ONE_BYTE };
+        enum {
+            SIZE_OF_BUFFER_ITEM_IS_NOT_ONE_BYTE,
+            MESSAGE_STRUCT_DOES_NOT_MATCH_SCHEMA
+        };
     };
 } // end of namespace vrpn_detail
 
@@ -450,6 +453,66 @@ inline int vrpn_unbuffer(ByteT **input, T *lvalue)
     return 0;
 }
 
+/// Reverses the byte order of count values that are each size bytes long,
+/// reading from "from" and writing to "to" (which may be the same place).
+/// Uses SSSE3 or AVX2 byte shuffles when the processor has them.  8-byte
+/// values come out in the same order vrpn_htond() would put them.  This is
+/// the kernel behind vrpn_buffer_array() and vrpn_unbuffer_array(), and can
+/// be called directly by code like the imager that packs bulk data itself.
+extern VRPN_API void vrpn_swap_array_bytes(void *to, const void *from,
+                                           size_t count, size_t size);
+
+/// Function template to buffer an array of count values in network byte
+/// order, like calling vrpn_buffer() on each but in a single pass.
+/// Advances the insert pointer and decrements the buffer length past the
+/// whole array.  Returns 0 on success, -1 if the buffer is too small.
+template <typename T, typename ByteT>
+inline int vrpn_buffer_array(ByteT **insertPt, vrpn_int32 *buflen,
+                             const T *values, vrpn_int32 count)
+{
+    VRPN_STATIC_ASSERT(sizeof(ByteT) == 1, SIZE_OF_BUFFER_ITEM_IS_NOT_ONE_BYTE);
+
+    if ((insertPt == NULL) || (buflen == NULL) || (count < 0)) {
+        fprintf(stderr, "vrpn_buffer_array: NULL pointer or bad count\n");
+        return -1;
+    }
+
+    size_t len = count * sizeof(T);
+    if (len > static_cast<size_t>(*buflen)) {
+        fprintf(stderr, "vrpn_buffer_array: buffer not large enough\n");
+        return -1;
+    }
+
+    if (vrpn_big_endian || (sizeof(T) == 1)) {
+        memcpy(*insertPt, values, len);
+    }
+    else {
+        vrpn_swap_array_bytes(*insertPt, values, count, sizeof(T));
+    }
+    *insertPt += len;
+    *buflen -= static_cast<vrpn_int32>(len);
+    return 0;
+}
+
+/// Function template to unbuffer an array of count values from network byte
+/// order into host order, advancing the input pointer past them.  The
+/// caller checks that the message holds that many values.  Returns 0.
+template <typename T, typename ByteT>
+inline int vrpn_unbuffer_array(ByteT **input, T *values, vrpn_int32 count)
+{
+    VRPN_STATIC_ASSERT(sizeof(ByteT) == 1, SIZE_OF_BUFFER_ITEM_IS_NOT_ONE_BYTE);
+
+    size_t len = count * sizeof(T);
+    if (vrpn_big_endian || (sizeof(T) == 1)) {
+        memcpy(values, *input, len);
+    }
+    else {
+        vrpn_swap_array_bytes(values, *input, count, sizeof(T));
+    }
+    *input += len;
+    return 0;
+}
+
 // Semaphore and Thread classes derived from Hans Weber's classes from UNC.
 // Don't let the existence of a Thread class fool you into thinking
 // that VRPN is thread-safe.  This and the Semaphore are included as
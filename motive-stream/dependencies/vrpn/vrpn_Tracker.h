@@ -26,7 +26,9 @@
 #include "vrpn_BaseClass.h" // for vrpn_Callback_List, etc
 #include "vrpn_Configure.h" // for VRPN_CALLBACK, VRPN_API, etc
 #include "vrpn_Connection.h"
-#include "vrpn_Shared.h" // for timeval
+#include "vrpn_FixedPoint.h"    // for vrpn::FixedPoint
+#include "vrpn_MessageSchema.h" // for vrpn_Schema, vrpn_SchemaField
+#include "vrpn_Shared.h"        // for timeval
 #include "vrpn_Types.h"  // for vrpn_float64, vrpn_int32, etc
 
 class VRPN_API vrpn_RedundantTransmission;
@@ -46,6 +48,71 @@ const int vrpn_ALL_SENSORS = -1;
 typedef vrpn_float64 vrpn_Tracker_Pos[3];
 typedef vrpn_float64 vrpn_Tracker_Quat[4];
 
+// Wire layouts of the position, velocity and acceleration reports, packed
+// and unpacked with vrpn_buffer_message()/vrpn_unbuffer_message().  The
+// padding keeps the vrpn_float64s 8-byte aligned;  servers fill it with
+// another copy of the sensor.
+struct vrpn_TRACKERPOSMSG {
+    vrpn_int32 sensor;
+    vrpn_int32 padding;
+    vrpn_float64 pos[3];
+    vrpn_float64 quat[4];
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_int32, 2>,
+                    vrpn_Schema<vrpn_SchemaField<vrpn_float64, 7> > >
+    vrpn_TRACKERPOSSCHEMA;
+
+struct vrpn_TRACKERVELMSG {
+    vrpn_int32 sensor;
+    vrpn_int32 padding;
+    vrpn_float64 vel[3];
+    vrpn_float64 vel_quat[4];
+    vrpn_float64 vel_quat_dt;
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_int32, 2>,
+                    vrpn_Schema<vrpn_SchemaField<vrpn_float64, 8> > >
+    vrpn_TRACKERVELSCHEMA;
+
+struct vrpn_TRACKERACCMSG {
+    vrpn_int32 sensor;
+    vrpn_int32 padding;
+    vrpn_float64 acc[3];
+    vrpn_float64 acc_quat[4];
+    vrpn_float64 acc_quat_dt;
+};
+typedef vrpn_TRACKERVELSCHEMA vrpn_TRACKERACCSCHEMA;
+
+// Compact position report, 24 bytes rather than 64, sent in place of
+// vrpn_TRACKERPOSMSG to clients that understand it when a server asks for
+// it (see vrpn_Tracker_Server::set_compact_reports()).  Each position is
+// vrpn_TRACKER_COMPACT_POS fixed point:  20 fractional bits, just under a
+// micron, out to +/- 2048 m.  The quaternion is sent "smallest three":
+// the top two of its 64 bits say which component was largest (and made
+// positive), and the other three follow in 20 bits each, to about 1e-6.
+// The largest is recovered from the fact that the quaternion is unit.
+typedef vrpn::FixedPoint<12, 20> vrpn_TRACKER_COMPACT_POS;
+struct vrpn_TRACKERCOMPACTMSG {
+    vrpn_int32 sensor;
+    vrpn_int32 pos[3];  // vrpn_TRACKER_COMPACT_POS values
+    vrpn_uint32 quat[2]; // High word first
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_int32, 4>,
+                    vrpn_Schema<vrpn_SchemaField<vrpn_uint32, 2> > >
+    vrpn_TRACKERCOMPACTSCHEMA;
+
+// Header of a frame report, which carries the poses of many sensors from
+// one capture instant under one timestamp (see
+// vrpn_Tracker_Server::report_frame()).  num_sensors vrpn_TRACKERPOSMSGs
+// follow it.  A frame too big for one message goes in parts numbered from
+// 0, each with the same frame number.
+struct vrpn_TRACKERFRAMEMSG {
+    vrpn_int32 frame;
+    vrpn_int32 num_sensors; // In this part
+    vrpn_int32 part;
+    vrpn_int32 parts;
+};
+typedef vrpn_Schema<vrpn_SchemaField<vrpn_int32, 4> > vrpn_TRACKERFRAMESCHEMA;
+
 class VRPN_API vrpn_Tracker : public vrpn_BaseClass {
 public:
     // vrpn_Tracker.cfg, in the "local" directory, is the default config file
@@ -78,6 +145,8 @@ public:
 
 protected:
     vrpn_int32 position_m_id;           // ID of tracker position message
+    vrpn_int32 position_compact_m_id;   // ID of compact position message
+    vrpn_int32 frame_m_id;              // ID of tracker frame message
     vrpn_int32 velocity_m_id;           // ID of tracker velocity message
     vrpn_int32 accel_m_id;              // ID of tracker acceleration message
     vrpn_int32 tracker2room_m_id;       // ID of tracker tracker2room message
@@ -128,6 +197,14 @@ protected:
 
     int status; // What are we doing?
 
+    // Whether position reports also go out in compact form, and the
+    // routines that turn that on and pack the compact report alongside
+    // the one encode_to() makes.
+    vrpn_bool d_compact_reports;
+    int enable_compact_reports(vrpn_bool on);
+    int pack_compact_report(vrpn_uint32 class_of_service,
+                            vrpn_int32 unless_accepted = -1);
+
     virtual int register_types(void); //< Called by BaseClass init()
     virtual int encode_to(char *buf); // Encodes the position report
     // Not all trackers will call the velocity and acceleration packers
@@ -230,6 +307,12 @@ public:
 
     void setRedundantTransmission(vrpn_RedundantTransmission *);
 
+    // As for vrpn_Tracker_Server; not used with redundant transmission.
+    int set_compact_reports(vrpn_bool on)
+    {
+        return enable_compact_reports(on);
+    }
+
 protected:
     vrpn_float64 update_rate;
 
@@ -272,6 +355,26 @@ public:
         const vrpn_float64 position[3], const vrpn_float64 quaternion[4],
         const vrpn_float64 interval,
         const vrpn_uint32 class_of_service = vrpn_CONNECTION_LOW_LATENCY);
+
+    /// Sends poses as vrpn_TRACKERCOMPACTMSG to each client whose
+    /// vrpn_Tracker_Remote reads it, and as usual to the rest (older
+    /// clients among them).  Off by default.
+    /// Returns -1 if there is no connection.
+    int set_compact_reports(vrpn_bool on)
+    {
+        return enable_compact_reports(on);
+    }
+
+    /// Reports the poses of count sensors captured at the same instant.
+    /// Clients whose vrpn_Tracker_Remote reads frames get them all in
+    /// one message (or a few, if they don't fit in one datagram) and see
+    /// each sensor's change callbacks and then the frame callback; older
+    /// clients get the usual message for each sensor.  Frames are numbered
+    /// from one.
+    virtual int report_frame(
+        const struct timeval t, const int count, const vrpn_int32 sensors[],
+        const vrpn_float64 positions[][3], const vrpn_float64 quaternions[][4],
+        const vrpn_uint32 class_of_service = vrpn_CONNECTION_LOW_LATENCY);
 };
 
 //----------------------------------------------------------
@@ -286,10 +389,36 @@ typedef struct _vrpn_TRACKERCB {
     vrpn_int32 sensor;       // Which sensor is reporting
     vrpn_float64 pos[3];     // Position of the sensor
     vrpn_float64 quat[4];    // Orientation of the sensor
+    struct timeval arrival_time; // When it reached this host, if known
 } vrpn_TRACKERCB;
 typedef void(VRPN_CALLBACK *vrpn_TRACKERCHANGEHANDLER)(
     void *userdata, const vrpn_TRACKERCB info);
 
+// Convert a pose to and from the compact position report.  The quaternion
+// need not be unit going in, and is coming out.
+extern VRPN_API void vrpn_compact_tracker_pose(vrpn_int32 sensor,
+                                               const vrpn_float64 pos[3],
+                                               const vrpn_float64 quat[4],
+                                               vrpn_TRACKERCOMPACTMSG *msg);
+extern VRPN_API void
+vrpn_expand_tracker_pose(const vrpn_TRACKERCOMPACTMSG &msg, vrpn_int32 *sensor,
+                         vrpn_float64 pos[3], vrpn_float64 quat[4]);
+
+// User routine to handle a whole frame of poses from a server that calls
+// report_frame().  It is called once the frame's sensors have been passed
+// to the position change callbacks.  The poses belong to the
+// vrpn_Tracker_Remote and are only good until the routine returns.
+
+typedef struct _vrpn_TRACKERFRAMECB {
+    struct timeval msg_time;        // Time of the frame
+    vrpn_int32 frame;               // Which frame it is
+    vrpn_int32 num_sensors;         // How many poses are in it
+    const vrpn_TRACKERCB *sensors;  // The poses, in the order sent
+    struct timeval arrival_time;    // When it reached this host, if known
+} vrpn_TRACKERFRAMECB;
+typedef void(VRPN_CALLBACK *vrpn_TRACKERFRAMEHANDLER)(
+    void *userdata, const vrpn_TRACKERFRAMECB info);
+
 // User routine to handle a tracker velocity update.  This is called when
 // the tracker callback is called (when a message from its counterpart
 // across the connetion arrives).
@@ -300,6 +429,7 @@ typedef struct _vrpn_TRACKERVELCB {
     vrpn_float64 vel[3];      // Velocity of the sensor
     vrpn_float64 vel_quat[4]; // Future Orientation of the sensor
     vrpn_float64 vel_quat_dt; // delta time (in secs) for vel_quat
+    struct timeval arrival_time; // When it reached this host, if known
 } vrpn_TRACKERVELCB;
 typedef void(VRPN_CALLBACK *vrpn_TRACKERVELCHANGEHANDLER)(
     void *userdata, const vrpn_TRACKERVELCB info);
@@ -314,7 +444,7 @@ typedef struct _vrpn_TRACKERACCCB {
     vrpn_float64 acc[3];      // Acceleration of the sensor
     vrpn_float64 acc_quat[4]; // ?????
     vrpn_float64 acc_quat_dt; // delta time (in secs) for acc_quat
-
+    struct timeval arrival_time; // When it reached this host, if known
 } vrpn_TRACKERACCCB;
 typedef void(VRPN_CALLBACK *vrpn_TRACKERACCCHANGEHANDLER)(
     void *userdata, const vrpn_TRACKERACCCB info);
@@ -398,6 +528,15 @@ public:
     // a PHANToM in its reset position)
     int reset_origin(void);
 
+    // Only handle the newest report from each sensor out of those read
+    // together, so that a client that has fallen behind skips stale
+    // poses rather than working through them (see
+    // vrpn_Connection::set_latest_only()).  Of a frame that comes in
+    // several parts, only the parts of the newest frame read are handled,
+    // so one whose last parts are read with the next frame loses them,
+    // along with its frame callback.
+    int set_latest_only(vrpn_bool on);
+
     // This routine calls the mainloop of the connection it's on
     virtual void mainloop();
 
@@ -467,6 +606,18 @@ public:
         return d_tracker2roomchange_list.unregister_handler(userdata, handler);
     };
 
+    // (un)Register a callback handler to handle a whole frame
+    virtual int register_change_handler(void *userdata,
+                                        vrpn_TRACKERFRAMEHANDLER handler)
+    {
+        return d_framechange_list.register_handler(userdata, handler);
+    };
+    virtual int unregister_change_handler(void *userdata,
+                                          vrpn_TRACKERFRAMEHANDLER handler)
+    {
+        return d_framechange_list.unregister_handler(userdata, handler);
+    };
+
 protected:
     // Callbacks with one per sensor (plus one for "all")
     vrpn_Tracker_Sensor_Callbacks all_sensor_callbacks;
@@ -477,10 +628,25 @@ protected:
     // Callbacks that are one per tracker
     vrpn_Callback_List<vrpn_TRACKERTRACKER2ROOMCB> d_tracker2roomchange_list;
     vrpn_Callback_List<vrpn_TRACKERWORKSPACECB> d_workspacechange_list;
+    vrpn_Callback_List<vrpn_TRACKERFRAMECB> d_framechange_list;
+
+    // The frame being put together from its parts
+    vrpn_TRACKERCB *d_frame_poses;
+    vrpn_int32 d_frame_max_poses;
+    vrpn_int32 d_frame_num_poses;
+    vrpn_int32 d_frame_number;
+    vrpn_int32 d_frame_next_part; // -1 if a part went missing
+
+    // Calls the position callbacks for all sensors and for tp's sensor.
+    int call_change_handlers(const vrpn_TRACKERCB &tp);
 
     static int VRPN_CALLBACK
     handle_change_message(void *userdata, vrpn_HANDLERPARAM p);
     static int VRPN_CALLBACK
+    handle_compact_change_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
+    handle_frame_message(void *userdata, vrpn_HANDLERPARAM p);
+    static int VRPN_CALLBACK
     handle_vel_change_message(void *userdata, vrpn_HANDLERPARAM p);
     static int VRPN_CALLBACK
     handle_acc_change_message(void *userdata, vrpn_HANDLERPARAM p);
@@ -0,0 +1,127 @@
+// Position hold for a Tello using mocap feedback over VRPN.
+//
+// Usage: tello-mocap-hold [Tracker0@192.168.1.42] [sensor] [tello ip] [tello port]
+//
+// Built with TELLO_WITH_NATNET (build-tello-mocap-hold-natnet.sh), poses come
+// straight from Motive over NatNet instead, and the first argument is
+// Motive's IP address; sensor is then the rigid body's streaming ID.
+//
+// Takes off, then holds the position/heading the drone had when the first
+// pose arrived after takeoff. Type "land" (or close stdin) to land. Pose ->
+// rc latency is printed every two seconds.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include "../EventLoop.hpp"
+#ifdef TELLO_WITH_NATNET
+#include "../NatNetPoseSource.hpp"
+#endif
+#include "../PoseSource.hpp"
+#include "../TelloController.hpp"
+#include "../TelloEngine.hpp"
+#include "../TelloTelemetry.hpp"
+
+int main(int argc, char** argv)
+{
+#ifdef TELLO_WITH_NATNET
+    const std::string tracker_address = argc > 1 ? argv[1] : "192.168.1.42";
+#else
+    const std::string tracker_address = argc > 1 ? argv[1] : "Tracker0@192.168.1.42";
+#endif
+    const int sensor = argc > 2 ? atoi(argv[2]) : 0;
+    const std::string tello_ip = argc > 3 ? argv[3] : "192.168.10.1";
+    const uint16_t tello_port = argc > 4 ? atoi(argv[4]) : 8889;
+
+    EventLoop loop;
+    TelloEngine tello(loop, tello_ip, tello_port);
+    if(!loop.ok() || !tello.ok()){
+        return -1;
+    }
+
+    TelloController::Config config;
+    config.rigidBodyId = sensor;
+    TelloController controller(loop, tello, config);
+
+    // Fuse onboard attitude from the 8890 state stream when it is available.
+    TelloTelemetry telemetry(loop);
+    int state_index = telemetry.ok() ? telemetry.addDrone(tello_ip) : -1;
+    if(state_index >= 0){
+        controller.setAttitudeSource(&telemetry.ring(state_index));
+    }
+
+    bool airborne = false;
+    bool have_target = false;
+    auto on_pose = [&](const PoseSample& sample) {
+        if(airborne && !have_target && sample.rigidBodyId == sensor){
+            controller.setTarget(sample.pose.point,
+                                 TelloController::yawFromQuaternion(sample.pose.quaternion));
+            controller.enable();
+            have_target = true;
+            std::cout << "Holding at " << sample.pose.point.x << ", "
+                      << sample.pose.point.y << ", " << sample.pose.point.z << std::endl;
+        }
+        controller.onPose(sample);
+    };
+#ifdef TELLO_WITH_NATNET
+    sNatNetClientConnectParams motive_params;
+    motive_params.connectionType = ConnectionType_Multicast;
+    motive_params.serverAddress = tracker_address.c_str();
+    NatNetPoseSource mocap(loop, motive_params, on_pose);
+    if(!mocap.ok()){
+        return -1;
+    }
+#else
+    VrpnPoseSource mocap(loop, tracker_address, on_pose);
+#endif
+
+    auto land = [&]() {
+        controller.disable();
+        tello.clearQueue();
+        tello.sendCommand("land", [&](bool, const std::string&) { loop.stop(); });
+    };
+
+    tello.sendCommand("command", [&](bool ok, const std::string& reply) {
+        if(!ok){
+            std::cerr << "Tello did not enter SDK mode: " << reply << std::endl;
+            loop.stop();
+            return;
+        }
+        tello.sendCommand("takeoff", [&](bool ok, const std::string& reply) {
+            if(!ok){
+                std::cerr << "Takeoff failed: " << reply << std::endl;
+                loop.stop();
+                return;
+            }
+            airborne = true;
+        });
+    });
+
+    loop.addTimer(2000, [&]() {
+        const TelloController::LatencyStats& stats = controller.latency();
+        printf("pose->rc latency: %llu samples, mean %.3f ms, min %.3f ms, max %.3f ms, "
+               "%llu over budget, %llu stale hovers, %llu fused\n",
+               (unsigned long long)stats.samples, stats.mean_ms, stats.min_ms, stats.max_ms,
+               (unsigned long long)stats.overBudget, (unsigned long long)stats.staleHovers,
+               (unsigned long long)stats.fusedSteps);
+        const TelloState* state = state_index >= 0 ? telemetry.ring(state_index).latest() : nullptr;
+        if(state){
+            printf("battery %d%%, tof %d cm, attitude %d/%d/%d deg\n", state->battery,
+                   state->tof, state->pitch, state->roll, state->yaw);
+        }
+    });
+
+    loop.addReader(STDIN_FILENO, [&]() {
+        char buf[256];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if(n <= 0 || std::string(buf, n).find("land") != std::string::npos){
+            loop.removeReader(STDIN_FILENO);
+            land();
+        }
+    });
+
+    loop.run();
+    return 0;
+}
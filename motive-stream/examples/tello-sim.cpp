@@ -0,0 +1,58 @@
+// Simulated Tello plus mocap, for running controllers on a laptop.
+//
+// Usage: tello-sim [command port] [vrpn port]
+//
+// Listens for SDK commands on 127.0.0.1:<command port> (default 9889, so it
+// does not collide with a client bound to 8889 on the same host) and
+// publishes the simulated drone as "Tracker0" on a VRPN server (default
+// 3883). For example, in two terminals:
+//   bin/tello-sim
+//   bin/tello-mocap-hold Tracker0@localhost 0 127.0.0.1 9889
+// Every five seconds the loop throughput and the pose publish -> rc arrival
+// latency are printed.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "vrpn_Connection.h"
+
+#include "../EventLoop.hpp"
+#include "../TelloSim.hpp"
+
+int main(int argc, char** argv)
+{
+    TelloSim::Config config;
+    config.commandPort = argc > 1 ? atoi(argv[1]) : 9889;
+    const int vrpn_port = argc > 2 ? atoi(argv[2]) : vrpn_DEFAULT_LISTEN_PORT_NO;
+
+    vrpn_Connection* connection = vrpn_create_server_connection(vrpn_port);
+    if(connection == nullptr || !connection->doing_okay()){
+        std::cerr << "Could not open VRPN server on port " << vrpn_port << std::endl;
+        return -1;
+    }
+
+    EventLoop loop;
+    TelloSim sim(loop, connection, "Tracker0", config);
+    if(!loop.ok() || !sim.ok()){
+        return -1;
+    }
+    std::cout << "Simulated Tello on port " << config.commandPort
+              << ", Tracker0 on VRPN port " << vrpn_port << std::endl;
+
+    const double report_s = 5.0;
+    loop.addTimer(static_cast<uint32_t>(report_s * 1000), [&]() {
+        const TelloSim::Stats& stats = sim.stats();
+        const Pose_msg& pose = sim.pose();
+        printf("%s at %.2f, %.2f, %.2f | %.1f rc/s, %.1f poses/s | "
+               "pose->rc mean %.3f ms max %.3f ms (%llu samples)\n",
+               sim.flying() ? "flying" : "grounded", pose.point.x, pose.point.y, pose.point.z,
+               stats.rcReceived / report_s, stats.posesPublished / report_s,
+               stats.loopMean_ms, stats.loopMax_ms, (unsigned long long)stats.loopSamples);
+        fflush(stdout);
+        sim.resetStats();
+    });
+
+    loop.run();
+    connection->removeReference();
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Position hold for several Tellos in station mode from one process.
+//
+// Usage: tello-swarm-hold Tracker0@192.168.1.42 <ip>[:port]=<sensor> [...]
+//
+// Each drone is paired with the VRPN sensor that tracks it. All drones share
+// one UDP socket and one event loop; each gets its own TelloController. Type
+// "land" (or close stdin) to land them all.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "../EventLoop.hpp"
+#include "../PoseSource.hpp"
+#include "../TelloController.hpp"
+#include "../TelloSwarm.hpp"
+
+int main(int argc, char** argv)
+{
+    if(argc < 3){
+        std::cerr << "Usage: " << argv[0] << " <tracker@host> <ip>=<sensor> ..." << std::endl;
+        return -1;
+    }
+
+    EventLoop loop;
+    TelloSwarm swarm(loop);
+    if(!loop.ok() || !swarm.ok()){
+        return -1;
+    }
+
+    std::vector<std::unique_ptr<TelloController>> controllers;
+    for(int i = 2; i < argc; i++){
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if(eq == std::string::npos){
+            std::cerr << "Expected <ip>=<sensor>, got " << arg << std::endl;
+            return -1;
+        }
+        int sensor = atoi(arg.c_str() + eq + 1);
+        std::string ip = arg.substr(0, eq);
+        uint16_t port = 8889;
+        size_t colon = ip.find(':');
+        if(colon != std::string::npos){
+            port = atoi(ip.c_str() + colon + 1);
+            ip.resize(colon);
+        }
+        int drone = swarm.addDrone(ip, sensor, port);
+        if(drone < 0){
+            return -1;
+        }
+        TelloController::Config config;
+        config.rigidBodyId = sensor;
+        controllers.emplace_back(new TelloController(loop,
+            [&swarm, drone](int a, int b, int c, int d) { return swarm.sendRc(drone, a, b, c, d); },
+            config));
+    }
+
+    std::vector<bool> airborne(swarm.size(), false);
+    std::vector<bool> holding(swarm.size(), false);
+    VrpnPoseSource mocap(loop, argv[1], [&](const PoseSample& sample) {
+        swarm.routePose(sample, [&](int drone, const PoseSample& pose) {
+            TelloController& controller = *controllers[drone];
+            if(airborne[drone] && !holding[drone]){
+                controller.setTarget(pose.pose.point,
+                                     TelloController::yawFromQuaternion(pose.pose.quaternion));
+                controller.enable();
+                holding[drone] = true;
+            }
+            controller.onPose(pose);
+        });
+    });
+
+    swarm.sendAll("command", [&](int drone, bool ok, const std::string& reply) {
+        if(!ok){
+            std::cerr << swarm.name(drone) << " did not enter SDK mode: " << reply << std::endl;
+            return;
+        }
+        swarm.sendCommand(drone, "takeoff", [&, drone](bool ok, const std::string& reply) {
+            std::cout << swarm.name(drone) << " takeoff: " << reply << std::endl;
+            airborne[drone] = ok;
+        });
+    });
+
+    size_t landed = 0;
+    auto land = [&]() {
+        for(size_t i = 0; i < swarm.size(); i++){
+            controllers[i]->disable();
+            swarm.clearQueue(i);
+        }
+        swarm.sendAll("land", [&](int, bool, const std::string&) {
+            if(++landed == swarm.size()){
+                loop.stop();
+            }
+        });
+    };
+
+    loop.addTimer(2000, [&]() {
+        for(size_t i = 0; i < swarm.size(); i++){
+            TelloSwarm::DroneStats stats = swarm.stats(i);
+            const TelloController::LatencyStats& latency = controllers[i]->latency();
+            printf("%s: seq %u/%u, %llu rc (%llu coalesced), %llu timeouts, "
+                   "pose->rc mean %.3f ms max %.3f ms\n",
+                   swarm.name(i).c_str(), stats.lastCompletedSeq, stats.lastQueuedSeq,
+                   (unsigned long long)stats.rcSent, (unsigned long long)stats.rcCoalesced,
+                   (unsigned long long)stats.timeouts, latency.mean_ms, latency.max_ms);
+        }
+    });
+
+    loop.addReader(STDIN_FILENO, [&]() {
+        char buf[256];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if(n <= 0 || std::string(buf, n).find("land") != std::string::npos){
+            loop.removeReader(STDIN_FILENO);
+            land();
+        }
+    });
+
+    loop.run();
+    return 0;
+}
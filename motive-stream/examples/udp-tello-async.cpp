@@ -0,0 +1,85 @@
+// Interactive Tello client built on TelloEngine. Unlike udp-tello-example.cpp
+// it never blocks on recvfrom: stdin, replies and timeouts are all serviced
+// from one event loop, and "rc" lines go straight out without waiting for
+// earlier commands to be acknowledged.
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include "../EventLoop.hpp"
+#include "../TelloEngine.hpp"
+
+int main(int argc, char** argv)
+{
+    // Optional arguments let this talk to a simulator instead of the drone.
+    const std::string tello_ip = argc > 1 ? argv[1] : "192.168.10.1";
+    const uint16_t tello_port = argc > 2 ? atoi(argv[2]) : 8889;
+
+    EventLoop loop;
+    TelloEngine tello(loop, tello_ip, tello_port);
+    if(!loop.ok() || !tello.ok()){
+        return -1;
+    }
+
+    auto print_reply = [](const std::string& cmd) {
+        return [cmd](bool ok, const std::string& reply) {
+            std::cout << cmd << " -> " << reply << (ok ? "" : " (failed)") << std::endl;
+        };
+    };
+
+    tello.sendCommand("command", print_reply("command"));
+
+    // The Tello lands by itself after 15 s without traffic.
+    loop.addTimer(10000, [&]() {
+        if(tello.pending() == 0){
+            tello.sendCommand("battery?", print_reply("battery?"));
+        }
+    });
+
+    // Read stdin ourselves rather than through std::cin so that several lines
+    // arriving in one read are not left sitting in a stream buffer that epoll
+    // cannot see.
+    std::string pending_input;
+    auto handle_line = [&](const std::string& message) {
+        if(message == "exit"){
+            loop.stop();
+            return;
+        }
+        if(message.compare(0, 3, "rc ") == 0){
+            int a, b, c, d;
+            if(sscanf(message.c_str(), "rc %d %d %d %d", &a, &b, &c, &d) == 4){
+                tello.sendRc(a, b, c, d);
+            }
+            return;
+        }
+        if(!message.empty()){
+            tello.sendCommand(message, print_reply(message));
+            std::cout << "Queued: " << message << " (" << tello.pending() << " pending)" << std::endl;
+        }
+    };
+    loop.addReader(STDIN_FILENO, [&]() {
+        char buf[256];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if(n <= 0){
+            loop.stop();
+            return;
+        }
+        pending_input.append(buf, n);
+        size_t eol;
+        while((eol = pending_input.find('\n')) != std::string::npos){
+            std::string line = pending_input.substr(0, eol);
+            pending_input.erase(0, eol + 1);
+            handle_line(line);
+        }
+    });
+
+    loop.run();
+
+    const TelloEngine::Stats& stats = tello.stats();
+    std::cout << "Sent " << stats.commandsSent << " commands (" << stats.retries
+              << " retries, " << stats.timeouts << " timeouts), "
+              << stats.rcSent << " rc setpoints" << std::endl;
+    return 0;
+}